@@ -0,0 +1,203 @@
+// Microbenchmarks for the indexing and query hot paths.
+//
+// The tree has no build manifest or third-party dependencies, so this is a
+// self-contained harness in the spirit of google-benchmark: each benchmark
+// reports wall time per operation over a fixed number of iterations.
+//
+// Build and run:
+//   g++ -std=c++17 -O2 -pthread -I.. search_bench.cpp ../search_server.cpp
+//       ../string_processing.cpp ../document.cpp ../search_cursor.cpp
+//       ../thread_pool.cpp ../search_stats.cpp -o search_bench
+//   (one command line; wrapped here for readability)
+//   ./search_bench [document_count] [vocab_size] [words_per_document]
+
+#include "paginator.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Zipf-distributed term picker: term ranks follow 1/rank^s, matching the
+// skew of real document text far better than a uniform draw.
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(size_t vocab_size, double skew = 1.0)
+        : cumulative_(vocab_size) {
+        double sum = 0.0;
+        for (size_t rank = 0; rank < vocab_size; ++rank) {
+            sum += 1.0 / pow(rank + 1, skew);
+            cumulative_[rank] = sum;
+        }
+        for (double& value : cumulative_) {
+            value /= sum;
+        }
+    }
+
+    size_t Next(mt19937& random) {
+        const double point = uniform_real_distribution<double>(0.0, 1.0)(random);
+        return lower_bound(cumulative_.begin(), cumulative_.end(), point) -
+            cumulative_.begin();
+    }
+
+private:
+    vector<double> cumulative_;
+};
+
+struct Corpus {
+    vector<string> documents;
+    vector<string> vocabulary;
+};
+
+Corpus GenerateCorpus(size_t document_count, size_t vocab_size, size_t words_per_document) {
+    Corpus corpus;
+    corpus.vocabulary.reserve(vocab_size);
+    for (size_t term = 0; term < vocab_size; ++term) {
+        corpus.vocabulary.push_back("term" + to_string(term));
+    }
+
+    mt19937 random(12345);
+    ZipfianGenerator zipf(vocab_size);
+    corpus.documents.reserve(document_count);
+    for (size_t doc = 0; doc < document_count; ++doc) {
+        string text;
+        for (size_t word = 0; word < words_per_document; ++word) {
+            if (!text.empty()) {
+                text += ' ';
+            }
+            text += corpus.vocabulary[zipf.Next(random)];
+        }
+        corpus.documents.push_back(move(text));
+    }
+    return corpus;
+}
+
+// Builds a query of the requested width from the most frequent terms,
+// mimicking broad navigational queries.
+string MakeQuery(const Corpus& corpus, size_t width) {
+    string query;
+    for (size_t term = 0; term < width && term < corpus.vocabulary.size(); ++term) {
+        if (!query.empty()) {
+            query += ' ';
+        }
+        query += corpus.vocabulary[term];
+    }
+    return query;
+}
+
+template <typename Body>
+void RunBenchmark(const string& name, size_t iterations, Body body) {
+    const auto started = chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        body(i);
+    }
+    const auto elapsed = chrono::steady_clock::now() - started;
+    const double ns_per_op =
+        chrono::duration_cast<chrono::nanoseconds>(elapsed).count() /
+        static_cast<double>(iterations);
+    cout << left << setw(44) << name << right << setw(14) << fixed
+        << setprecision(0) << ns_per_op << " ns/op" << setw(12) << iterations
+        << " iters" << endl;
+}
+
+// Keeps the optimizer from discarding benchmark results
+volatile size_t do_not_optimize_away = 0;
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t document_count = argc > 1 ? stoul(argv[1]) : 10000;
+    const size_t vocab_size = argc > 2 ? stoul(argv[2]) : 5000;
+    const size_t words_per_document = argc > 3 ? stoul(argv[3]) : 50;
+
+    cout << "corpus: " << document_count << " documents, vocab " << vocab_size
+        << ", " << words_per_document << " words/document" << endl;
+    const Corpus corpus = GenerateCorpus(document_count, vocab_size, words_per_document);
+
+    RunBenchmark("SplitIntoWords", document_count, [&](size_t i) {
+        do_not_optimize_away += SplitIntoWords(corpus.documents[i]).size();
+    });
+
+    SearchServer server("and in at"s);
+    RunBenchmark("AddDocument", document_count, [&](size_t i) {
+        server.AddDocument(i, corpus.documents[i], DocumentStatus::ACTUAL,
+            { static_cast<int>(i % 10) });
+    });
+
+    {
+        vector<SearchServer::DocumentInput> batch;
+        batch.reserve(document_count);
+        for (size_t i = 0; i < document_count; ++i) {
+            batch.push_back({ static_cast<int>(i), corpus.documents[i],
+                DocumentStatus::ACTUAL, { static_cast<int>(i % 10) } });
+        }
+        SearchServer bulk_server("and in at"s);
+        RunBenchmark("AddDocuments (bulk)", 1, [&](size_t) {
+            bulk_server.AddDocuments(batch);
+        });
+    }
+
+    for (const size_t width : { size_t{1}, size_t{4}, size_t{16} }) {
+        const string query = MakeQuery(corpus, width);
+        RunBenchmark("FindTopDocuments width=" + to_string(width) + " (tree)", 200,
+            [&](size_t) {
+                do_not_optimize_away += server.FindTopDocuments(query).size();
+            });
+    }
+
+    server.Compact();
+    for (const size_t width : { size_t{1}, size_t{4}, size_t{16} }) {
+        const string query = MakeQuery(corpus, width);
+        RunBenchmark("FindTopDocuments width=" + to_string(width) + " (compact)", 200,
+            [&](size_t) {
+                do_not_optimize_away += server.FindTopDocuments(query).size();
+            });
+        RunBenchmark("FindTopDocuments width=" + to_string(width) + " (par)", 200,
+            [&](size_t) {
+                do_not_optimize_away +=
+                    server.FindTopDocuments(execution::par, query).size();
+            });
+    }
+
+    server.Compact(/*compress_postings=*/true);
+    for (const size_t width : { size_t{1}, size_t{4}, size_t{16} }) {
+        const string query = MakeQuery(corpus, width);
+        RunBenchmark("FindTopDocuments width=" + to_string(width) + " (compressed)", 200,
+            [&](size_t) {
+                do_not_optimize_away += server.FindTopDocuments(query).size();
+            });
+    }
+    server.Compact();
+
+    {
+        const string query = MakeQuery(corpus, 8);
+        RunBenchmark("MatchDocument", 2000, [&](size_t i) {
+            do_not_optimize_away +=
+                get<0>(server.MatchDocument(query, i % document_count)).size();
+        });
+    }
+
+    {
+        const auto results = server.FindTopDocuments(
+            MakeQuery(corpus, 4),
+            [](int, DocumentStatus, int) { return true; }, document_count);
+        RunBenchmark("Paginator iteration", 500, [&](size_t) {
+            size_t pages = 0;
+            for (const auto& page : Paginate(results, 50)) {
+                pages += page.size();
+            }
+            do_not_optimize_away += pages;
+        });
+    }
+
+    return 0;
+}
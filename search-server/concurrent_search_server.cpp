@@ -0,0 +1,62 @@
+#include "concurrent_search_server.h"
+
+using namespace std;
+
+void ConcurrentSearchServer::AddDocument(int document_id, string_view document,
+    DocumentStatus status, const vector<int>& ratings) {
+    unique_lock guard(mutex_);
+    server_.AddDocument(document_id, document, status, ratings);
+}
+
+void ConcurrentSearchServer::AddDocuments(const vector<SearchServer::DocumentInput>& documents) {
+    unique_lock guard(mutex_);
+    server_.AddDocuments(documents);
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    unique_lock guard(mutex_);
+    server_.RemoveDocument(document_id);
+}
+
+void ConcurrentSearchServer::UpdateDocument(int document_id, string_view document,
+    DocumentStatus status, const vector<int>& ratings) {
+    unique_lock guard(mutex_);
+    server_.UpdateDocument(document_id, document, status, ratings);
+}
+
+vector<Document> ConcurrentSearchServer::FindTopDocuments(string_view raw_query,
+    DocumentStatus status) const {
+    shared_lock guard(mutex_);
+    return server_.FindTopDocuments(raw_query, status);
+}
+
+vector<Document> ConcurrentSearchServer::FindTopDocuments(string_view raw_query) const {
+    shared_lock guard(mutex_);
+    return server_.FindTopDocuments(raw_query);
+}
+
+int ConcurrentSearchServer::GetDocumentCount() const {
+    shared_lock guard(mutex_);
+    return server_.GetDocumentCount();
+}
+
+tuple<vector<string_view>, DocumentStatus> ConcurrentSearchServer::MatchDocument(
+    string_view raw_query, int document_id) const {
+    shared_lock guard(mutex_);
+    return server_.MatchDocument(raw_query, document_id);
+}
+
+void ConcurrentSearchServer::Compact() {
+    unique_lock guard(mutex_);
+    server_.Compact();
+}
+
+void ConcurrentSearchServer::SaveIndex(const string& path) const {
+    shared_lock guard(mutex_);
+    server_.SaveIndex(path);
+}
+
+void ConcurrentSearchServer::LoadIndex(const string& path) {
+    unique_lock guard(mutex_);
+    server_.LoadIndex(path);
+}
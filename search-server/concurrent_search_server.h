@@ -0,0 +1,67 @@
+#pragma once
+#include "document.h"
+#include "search_server.h"
+
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// Thread-safe facade over a single shared SearchServer: any number of
+// concurrent FindTopDocuments / MatchDocument readers run under a shared
+// lock (queries on a frozen index never mutate it), while AddDocument /
+// AddDocuments / RemoveDocument / UpdateDocument / Compact writers take
+// the lock exclusively. One shared
+// index replaces the per-thread replica per core that the bare class
+// requires. Writer coordination is a reader-writer lock rather than
+// per-term shards because the compact and snapshot representations rely
+// on globally sorted term iteration.
+class ConcurrentSearchServer {
+public:
+    template <typename StringContainer>
+    explicit ConcurrentSearchServer(const StringContainer& stop_words)
+        : server_(stop_words) {
+    }
+    explicit ConcurrentSearchServer(std::string_view stop_words_text)
+        : server_(stop_words_text) {
+    }
+    ConcurrentSearchServer() = default;
+
+    void AddDocument(int document_id, std::string_view document,
+        DocumentStatus status, const std::vector<int>& ratings);
+
+    void AddDocuments(const std::vector<SearchServer::DocumentInput>& documents);
+
+    void RemoveDocument(int document_id);
+
+    void UpdateDocument(int document_id, std::string_view document,
+        DocumentStatus status, const std::vector<int>& ratings);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentPredicate document_predicate) const {
+        std::shared_lock guard(mutex_);
+        return server_.FindTopDocuments(raw_query, document_predicate);
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    int GetDocumentCount() const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        std::string_view raw_query, int document_id) const;
+
+    void Compact();
+
+    void SaveIndex(const std::string& path) const;
+
+    void LoadIndex(const std::string& path);
+
+private:
+    SearchServer server_;
+    mutable std::shared_mutex mutex_;
+};
@@ -1,8 +1,18 @@
 #include "document.h"
+#include <cmath>
 #include <string>
 
 using namespace std;
 
+bool RanksHigher(const Document& lhs, const Document& rhs) {
+    if (abs(lhs.relevance - rhs.relevance) < 1e-6) {
+        return lhs.rating > rhs.rating;
+    }
+    else {
+        return lhs.relevance > rhs.relevance;
+    }
+}
+
 Document::Document(int id, double relevance, int rating)
     : id(id), relevance(relevance), rating(rating) {}
 
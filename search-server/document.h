@@ -13,6 +13,10 @@ struct Document {
 
 std::ostream& operator<<(std::ostream& os, const Document& doc);
 
+// Result ordering shared by ranking code: higher relevance first, rating
+// as the tie-breaker within a 1e-6 relevance tolerance.
+bool RanksHigher(const Document& lhs, const Document& rhs);
+
 enum class DocumentStatus {
     ACTUAL,
     IRRELEVANT,
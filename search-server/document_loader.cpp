@@ -0,0 +1,155 @@
+#include "document_loader.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "string_processing.h"
+
+using namespace std;
+
+namespace {
+
+// Chunk size for sequential reads. Large enough to keep an NVMe queue
+// busy, small enough that the bounded queue stays memory-friendly.
+constexpr size_t READ_CHUNK_BYTES = 1 << 20;
+
+// Bounded single-producer single-consumer queue of line batches. The
+// reader blocks when the parser falls behind, capping memory use.
+class LineBatchQueue {
+public:
+    explicit LineBatchQueue(size_t capacity)
+        : capacity_(capacity) {}
+
+    void Push(vector<string> batch) {
+        unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] { return batches_.size() < capacity_; });
+        batches_.push_back(move(batch));
+        not_empty_.notify_one();
+    }
+
+    void Close() {
+        lock_guard lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_one();
+    }
+
+    // Returns false once the queue is closed and drained
+    bool Pop(vector<string>& batch) {
+        unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return !batches_.empty() || closed_; });
+        if (batches_.empty()) {
+            return false;
+        }
+        batch = move(batches_.front());
+        batches_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+private:
+    const size_t capacity_;
+    mutex mutex_;
+    condition_variable not_full_;
+    condition_variable not_empty_;
+    deque<vector<string>> batches_;
+    bool closed_ = false;
+};
+
+string_view NextField(string_view& line) {
+    const size_t tab = line.find('\t');
+    if (tab == string_view::npos) {
+        throw invalid_argument("Malformed corpus line: "s + string(line));
+    }
+    const string_view field = line.substr(0, tab);
+    line.remove_prefix(tab + 1);
+    return field;
+}
+
+SearchServer::DocumentInput ParseCorpusLine(string_view line) {
+    SearchServer::DocumentInput document;
+    document.id = stoi(string(NextField(line)));
+    document.status = static_cast<DocumentStatus>(stoi(string(NextField(line))));
+    for (string_view rating : SplitIntoWords(NextField(line))) {
+        document.ratings.push_back(stoi(string(rating)));
+    }
+    document.text = string(line);
+    return document;
+}
+
+}  // namespace
+
+size_t LoadDocumentsFromFile(SearchServer& search_server, const string& path,
+    size_t batch_size) {
+    ifstream input(path, ios::binary);
+    if (!input) {
+        throw runtime_error("Cannot open "s + path + " for reading"s);
+    }
+
+    LineBatchQueue queue(4);
+    thread reader([&input, &queue, batch_size] {
+        vector<string> lines;
+        string carry;
+        vector<char> chunk(READ_CHUNK_BYTES);
+        while (input) {
+            input.read(chunk.data(), chunk.size());
+            string_view text(chunk.data(), input.gcount());
+            size_t pos = 0;
+            while (true) {
+                const size_t newline = text.find('\n', pos);
+                if (newline == string_view::npos) {
+                    carry.append(text.substr(pos));
+                    break;
+                }
+                carry.append(text.substr(pos, newline - pos));
+                if (!carry.empty()) {
+                    lines.push_back(move(carry));
+                    carry.clear();
+                    if (lines.size() == batch_size) {
+                        queue.Push(move(lines));
+                        lines.clear();
+                    }
+                }
+                pos = newline + 1;
+            }
+        }
+        if (!carry.empty()) {
+            lines.push_back(move(carry));
+        }
+        if (!lines.empty()) {
+            queue.Push(move(lines));
+        }
+        queue.Close();
+    });
+
+    size_t documents_added = 0;
+    exception_ptr failure;
+    vector<string> lines;
+    while (queue.Pop(lines)) {
+        if (failure) {
+            // Keep draining so the reader can finish, but add nothing more
+            continue;
+        }
+        try {
+            vector<SearchServer::DocumentInput> batch;
+            batch.reserve(lines.size());
+            for (const string& line : lines) {
+                batch.push_back(ParseCorpusLine(line));
+            }
+            search_server.AddDocuments(batch);
+            documents_added += batch.size();
+        }
+        catch (...) {
+            failure = current_exception();
+        }
+    }
+    reader.join();
+    if (failure) {
+        rethrow_exception(failure);
+    }
+    return documents_added;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "search_server.h"
+
+// Streaming bulk loader for corpus files.
+//
+// File format: one document per line, tab-separated fields
+//   id '\t' status '\t' ratings '\t' text
+// where status is the integer value of DocumentStatus and ratings is a
+// space-separated list (possibly empty).
+//
+// Reading and indexing are pipelined: a reader thread pulls the file in
+// large sequential chunks and hands complete lines over a bounded queue,
+// while the calling thread parses them and feeds the server in batches
+// through AddDocuments. Disk reads therefore overlap tokenization and
+// index insertion instead of alternating with them.
+//
+// Returns the number of documents added. Throws std::runtime_error if the
+// file cannot be read and std::invalid_argument on a malformed line; the
+// batch containing the bad line is not added.
+size_t LoadDocumentsFromFile(SearchServer& search_server, const std::string& path,
+    size_t batch_size = 1024);
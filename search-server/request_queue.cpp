@@ -1,39 +1,194 @@
 #include "request_queue.h"
 
+#include <cmath>
+
 using namespace std;
 
 RequestQueue::RequestQueue(const SearchServer& search_server)
-    : search_server_(search_server)
+    : requests_(min_in_day_)
+    , search_server_(search_server)
     , no_results_requests_(0)
     , current_time_(0) {
 }
 
 vector<Document> RequestQueue::AddFindRequest(const string& raw_query, DocumentStatus status) {
+    const auto started = chrono::steady_clock::now();
+    if (search_server_.GetIndexVersion() != cached_index_version_) {
+        cache_.clear();
+        lru_order_.clear();
+        cached_index_version_ = search_server_.GetIndexVersion();
+    }
+    const string key = MakeCacheKey(raw_query, status);
+    if (const vector<Document>* cached = LookUpCache(key)) {
+        AddRequest(cached->size());
+        RecordLatency(chrono::steady_clock::now() - started);
+        return *cached;
+    }
     const auto result = search_server_.FindTopDocuments(raw_query, status);
+    StoreInCache(key, result);
     AddRequest(result.size());
+    RecordLatency(chrono::steady_clock::now() - started);
     return result;
 }
 
 vector<Document> RequestQueue::AddFindRequest(const string& raw_query) {
-    const auto result = search_server_.FindTopDocuments(raw_query);
-    AddRequest(result.size());
-    return result;
+    return AddFindRequest(raw_query, DocumentStatus::ACTUAL);
+}
+
+future<vector<Document>> RequestQueue::AddFindRequestAsync(string raw_query,
+    DocumentStatus status) {
+    return SearchServer::QueryPool().Submit(
+        [this, raw_query = move(raw_query), status] {
+            lock_guard guard(async_mutex_);
+            return AddFindRequest(raw_query, status);
+        });
+}
+
+future<vector<Document>> RequestQueue::AddFindRequestAsync(string raw_query) {
+    return AddFindRequestAsync(move(raw_query), DocumentStatus::ACTUAL);
+}
+
+void RequestQueue::RecordLatency(chrono::steady_clock::duration elapsed) {
+    const auto nanoseconds =
+        max<int64_t>(1, chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    size_t bucket = 0;
+    for (uint64_t value = nanoseconds; value >>= 1;) {
+        ++bucket;
+    }
+    ++latency_buckets_[min(bucket, latency_bucket_count_ - 1)];
+
+    const auto now = chrono::steady_clock::now();
+    recent_request_times_.push_back(now);
+    while (!recent_request_times_.empty() &&
+        now - recent_request_times_.front() > chrono::minutes(1)) {
+        recent_request_times_.pop_front();
+    }
+}
+
+double RequestQueue::EstimatePercentileMs(double percentile) const {
+    uint64_t total = 0;
+    for (const uint64_t count : latency_buckets_) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    const uint64_t target = static_cast<uint64_t>(ceil(percentile * total));
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < latency_bucket_count_; ++bucket) {
+        cumulative += latency_buckets_[bucket];
+        if (cumulative >= target) {
+            // Geometric midpoint of [2^bucket, 2^(bucket + 1)) nanoseconds
+            return exp2(bucket + 0.5) / 1e6;
+        }
+    }
+    return 0.0;
+}
+
+RequestQueue::LatencyStats RequestQueue::GetLatencyStats() const {
+    lock_guard guard(async_mutex_);
+    LatencyStats stats;
+    for (const uint64_t count : latency_buckets_) {
+        stats.requests += count;
+    }
+    stats.p50_ms = EstimatePercentileMs(0.50);
+    stats.p95_ms = EstimatePercentileMs(0.95);
+    stats.p99_ms = EstimatePercentileMs(0.99);
+    const auto now = chrono::steady_clock::now();
+    for (const auto& completed : recent_request_times_) {
+        if (now - completed <= chrono::minutes(1)) {
+            ++stats.requests_last_minute;
+        }
+    }
+    return stats;
 }
 
 int RequestQueue::GetNoResultRequests() const {
     return no_results_requests_;
 }
 
+RequestQueue::WindowStats RequestQueue::GetWindowStats() const {
+    lock_guard guard(async_mutex_);
+    WindowStats stats;
+    stats.requests = window_size_;
+    stats.no_result_requests = no_results_requests_;
+    stats.result_histogram = result_histogram_;
+    if (window_size_ >= 2) {
+        const auto& oldest = requests_[window_head_];
+        const auto& newest =
+            requests_[(window_head_ + window_size_ - 1) % requests_.size()];
+        const double seconds =
+            chrono::duration<double>(newest.completed - oldest.completed).count();
+        if (seconds > 0.0) {
+            stats.qps = window_size_ / seconds;
+        }
+    }
+    return stats;
+}
+
 void RequestQueue::AddRequest(int results_num) {
     ++current_time_;
-    while (!requests_.empty() && min_in_day_ <= current_time_ - requests_.front().timestamp) {
-        if (0 == requests_.front().results) {
+    // Timestamps advance by one per request, so at most one entry expires
+    // here and the ring never outgrows its fixed capacity
+    while (window_size_ > 0 &&
+        min_in_day_ <= current_time_ - requests_[window_head_].timestamp) {
+        const QueryResult& oldest = requests_[window_head_];
+        if (0 == oldest.results) {
             --no_results_requests_;
         }
-        requests_.pop_front();
+        --result_histogram_[ResultBucket(oldest.results)];
+        window_head_ = (window_head_ + 1) % requests_.size();
+        --window_size_;
     }
-    requests_.push_back({ current_time_, results_num });
+    requests_[(window_head_ + window_size_) % requests_.size()] =
+        { current_time_, results_num, chrono::steady_clock::now() };
+    ++window_size_;
+    ++result_histogram_[ResultBucket(results_num)];
     if (0 == results_num) {
         ++no_results_requests_;
     }
-}
\ No newline at end of file
+}
+
+size_t RequestQueue::ResultBucket(int results_num) {
+    if (results_num <= 0) {
+        return 0;
+    }
+    size_t bucket = 1;
+    for (unsigned value = results_num; value >>= 1;) {
+        ++bucket;
+    }
+    return min(bucket, result_bucket_count_ - 1);
+}
+
+string RequestQueue::MakeCacheKey(string_view raw_query, DocumentStatus status) {
+    // Collapse whitespace so trivially different spellings share an entry
+    string key;
+    key.reserve(raw_query.size() + 2);
+    for (string_view word : SplitIntoWords(raw_query)) {
+        if (!key.empty()) {
+            key += ' ';
+        }
+        key += word;
+    }
+    key += '\0';
+    key += static_cast<char>(status);
+    return key;
+}
+
+const vector<Document>* RequestQueue::LookUpCache(const string& key) {
+    const auto entry = cache_.find(key);
+    if (entry == cache_.end()) {
+        return nullptr;
+    }
+    lru_order_.splice(lru_order_.begin(), lru_order_, entry->second.lru_position);
+    return &entry->second.results;
+}
+
+void RequestQueue::StoreInCache(const string& key, const vector<Document>& results) {
+    if (cache_.size() >= cache_capacity_) {
+        cache_.erase(lru_order_.back());
+        lru_order_.pop_back();
+    }
+    lru_order_.push_front(key);
+    cache_[key] = CacheEntry{ results, lru_order_.begin() };
+}
@@ -1,9 +1,14 @@
 #pragma once
 #include "document.h"
 #include "search_server.h"
+#include <array>
+#include <chrono>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <deque>
+#include <list>
+#include <map>
 #include <cstdint>
 
 class RequestQueue {
@@ -15,25 +20,113 @@ public:
     std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
     std::vector<Document> AddFindRequest(const std::string& raw_query);
 
+    // Asynchronous counterparts executed on the shared query pool. The
+    // queue's statistics and cache are updated under an internal mutex, so
+    // the async entry points may be called concurrently; mixing them with
+    // unsynchronized blocking AddFindRequest calls is the caller's concern.
+    std::future<std::vector<Document>> AddFindRequestAsync(std::string raw_query,
+        DocumentStatus status);
+    std::future<std::vector<Document>> AddFindRequestAsync(std::string raw_query);
+
     int GetNoResultRequests() const;
 
+    // Latency and throughput of the AddFindRequest entry points, measured
+    // in real time. Percentiles come from a log-scale histogram, so they
+    // are estimates within one power-of-two bucket of the true value.
+    struct LatencyStats {
+        std::uint64_t requests = 0;
+        double p50_ms = 0.0;
+        double p95_ms = 0.0;
+        double p99_ms = 0.0;
+        // Requests observed in the trailing real-time minute.
+        std::uint64_t requests_last_minute = 0;
+    };
+
+    LatencyStats GetLatencyStats() const;
+
+    // Log-scale buckets for the windowed result-count histogram.
+    static const size_t result_bucket_count_ = 16;
+
+    // Aggregates over the sliding request window, maintained incrementally
+    // on insert and evict so reading them never re-scans the window.
+    struct WindowStats {
+        std::uint64_t requests = 0;
+        std::uint64_t no_result_requests = 0;
+        // Bucket 0 counts empty results; bucket i >= 1 counts result sizes
+        // in [2^(i-1), 2^i), with the last bucket absorbing the tail.
+        std::array<std::uint64_t, result_bucket_count_> result_histogram{};
+        // Requests per second across the real time the window spans.
+        double qps = 0.0;
+    };
+
+    WindowStats GetWindowStats() const;
+
 private:
     struct QueryResult {
         std::uint64_t timestamp;
         int results;
+        std::chrono::steady_clock::time_point completed;
     };
-    std::deque<QueryResult> requests_;
+    // Fixed-capacity ring buffer over the sliding window: the capacity
+    // equals the window length, so insert and evict are O(1) index moves
+    // with no steady-state allocation.
+    std::vector<QueryResult> requests_;
+    size_t window_head_ = 0;
+    size_t window_size_ = 0;
     const SearchServer& search_server_;
     int no_results_requests_;
     std::uint64_t current_time_;
     const static int min_in_day_ = 1440;
 
+    // LRU cache of the skewed query traffic: keyed by the normalized query
+    // plus the requested status, dropped wholesale whenever the index
+    // version moves. Predicate overloads bypass the cache since a lambda
+    // has no usable identity.
+    struct CacheEntry {
+        std::vector<Document> results;
+        std::list<std::string>::iterator lru_position;
+    };
+    const static size_t cache_capacity_ = 256;
+    std::list<std::string> lru_order_;
+    std::map<std::string, CacheEntry, std::less<>> cache_;
+    std::uint64_t cached_index_version_ = 0;
+
+    // Serializes async requests against the statistics and the cache.
+    mutable std::mutex async_mutex_;
+
+    // Log-scale latency histogram: bucket i covers [2^i, 2^(i+1)) ns.
+    static const size_t latency_bucket_count_ = 48;
+    std::array<std::uint64_t, latency_bucket_count_> latency_buckets_{};
+    // Completion times of recent requests, pruned to the trailing minute.
+    std::deque<std::chrono::steady_clock::time_point> recent_request_times_;
+
+    // Result-count histogram over the current window, updated on insert
+    // and evict.
+    std::array<std::uint64_t, result_bucket_count_> result_histogram_{};
+
+    void RecordLatency(std::chrono::steady_clock::duration elapsed);
+
+    static size_t ResultBucket(int results_num);
+
+    // Smallest bucket midpoint covering the requested fraction of requests.
+    double EstimatePercentileMs(double percentile) const;
+
     void AddRequest(int results_num);
+
+    static std::string MakeCacheKey(std::string_view raw_query, DocumentStatus status);
+
+    // Returns the cached results for the key, or nullptr on a miss;
+    // refreshes the entry's LRU position on a hit.
+    const std::vector<Document>* LookUpCache(const std::string& key);
+
+    void StoreInCache(const std::string& key, const std::vector<Document>& results);
 };
 
 template <typename DocumentPredicate>
 std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
+    const auto started = std::chrono::steady_clock::now();
     const auto result = search_server_.FindTopDocuments(raw_query, document_predicate);
     AddRequest(result.size());
+    RecordLatency(std::chrono::steady_clock::now() - started);
     return result;
-}
\ No newline at end of file
+}
@@ -0,0 +1,36 @@
+#include "search_cursor.h"
+
+#include <algorithm>
+
+using namespace std;
+
+SearchCursor::SearchCursor(vector<Document> documents, size_t page_size)
+    : documents_(move(documents))
+    , page_size_(page_size) {
+}
+
+SearchCursor::Page SearchCursor::GetPage(size_t page_index) {
+    const size_t first = min(page_index * page_size_, documents_.size());
+    const size_t last = min(first + page_size_, documents_.size());
+    RankUpTo(last);
+    return { documents_.begin() + first, documents_.begin() + last };
+}
+
+size_t SearchCursor::PageCount() const {
+    return (documents_.size() + page_size_ - 1) / page_size_;
+}
+
+size_t SearchCursor::DocumentCount() const {
+    return documents_.size();
+}
+
+void SearchCursor::RankUpTo(size_t count) {
+    if (count <= ranked_count_) {
+        return;
+    }
+    // The prefix [0, ranked_count_) already holds the global best documents
+    // in order, so ranking the suffix extends it without touching the prefix.
+    partial_sort(documents_.begin() + ranked_count_, documents_.begin() + count,
+        documents_.end(), RanksHigher);
+    ranked_count_ = count;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+
+#include "document.h"
+#include "paginator.h"
+
+// Lazily ranked view over a query's matched documents. Relevance is
+// accumulated once when the cursor is created, but ordering happens page
+// by page: GetPage(n) ranks only the first (n + 1) * page_size documents,
+// so serving page 3 never pays for a full sort of the candidate set and
+// deeper pages extend the ranked prefix incrementally.
+//
+// Pages are IteratorRange instances, so cursor pages print and iterate
+// exactly like the pages produced by Paginate.
+class SearchCursor {
+public:
+    using Page = IteratorRange<std::vector<Document>::const_iterator>;
+
+    SearchCursor(std::vector<Document> documents, size_t page_size);
+
+    // Ranked page at page_index; an empty range past the last page.
+    Page GetPage(size_t page_index);
+
+    size_t PageCount() const;
+
+    size_t DocumentCount() const;
+
+private:
+    // Extends the ranked prefix to at least count documents.
+    void RankUpTo(size_t count);
+
+    std::vector<Document> documents_;
+    size_t page_size_;
+    size_t ranked_count_ = 0;
+};
@@ -1,90 +1,1065 @@
 #include "search_server.h"
 
 #include <cmath>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SEARCH_SERVER_HAS_MMAP 1
+#endif
+
 using namespace std;
 
-SearchServer::SearchServer(const std::string& stop_words_text)
+namespace {
+
+// On-disk layout of an index snapshot (all values in host byte order):
+//   SnapshotHeader
+//   DocumentEntry[document_count]            (sorted by id)
+//   int[document_count]                      (ids in insertion order)
+//   padding to 8 bytes
+//   size_t[term_count + 1]                   (postings offsets per term)
+//   uint32_t[term_count]                     (term lengths)
+//   char[term_char_count]                    (term characters back to back)
+//   padding to alignof(Posting)
+//   Posting[posting_count]
+struct SnapshotHeader {
+    char magic[8];
+    uint64_t document_count;
+    uint64_t term_count;
+    uint64_t posting_count;
+    uint64_t term_char_count;
+};
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'S', 'S', 'I', 'D', 'X', '0', '2', '\0' };
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void WritePadding(ostream& output, size_t written, size_t alignment) {
+    static const char zeros[alignof(max_align_t)] = {};
+    output.write(zeros, AlignUp(written, alignment) - written);
+}
+
+void EncodeVarint(vector<unsigned char>& bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<unsigned char>(value) | 0x80);
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<unsigned char>(value));
+}
+
+}  // namespace
+
+SearchServer::SearchServer(std::string_view stop_words_text)
     : SearchServer(SplitIntoWords(stop_words_text)) {}
 
-void SearchServer::AddDocument(int document_id, const string& document,
+SearchServer::SearchServer(const std::string& stop_words_text)
+    : SearchServer(std::string_view(stop_words_text)) {}
+
+void SearchServer::AddDocument(int document_id, string_view document,
     DocumentStatus status, const vector<int>& ratings) {
-    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+    if (snapshot_) {
+        throw logic_error("Cannot add documents to a snapshot-backed index"s);
+    }
+    if ((document_id < 0) || (document_slots_.count(document_id) > 0)) {
         throw invalid_argument("Invalid document_id"s);
     }
+    if (removed_document_ids_.erase(document_id) > 0) {
+        // Re-adding a tombstoned id: its stale postings must go first
+        PurgeDocumentPostings(document_id);
+    }
     const auto words = SplitIntoWordsNoStop(document);
 
     const double inv_word_count = 1.0 / words.size();
+    vector<TermId> occurrence_terms;
+    occurrence_terms.reserve(words.size());
     for (const string& word : words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
+        const TermId term_id = InternTerm(word);
+        occurrence_terms.push_back(term_id);
+        term_postings_[term_id][document_id] += inv_word_count;
     }
-    documents_.emplace(document_id,
-        DocumentData{ ComputeAverageRating(ratings), status });
+    AddDocumentSlot(document_id, status, ratings);
+    AppendForwardEntries(move(occurrence_terms));
     document_ids_.push_back(document_id);
+    compact_index_.frozen = false;
+    InvalidateIdfCache();
+    ++index_version_;
+}
+
+SearchServer::TermId SearchServer::InternTerm(string_view word) {
+    const auto existing = term_ids_.find(word);
+    if (existing != term_ids_.end()) {
+        return existing->second;
+    }
+    term_strings_.emplace_back(word);
+    const TermId term_id = term_strings_.size() - 1;
+    term_ids_.emplace(term_strings_.back(), term_id);
+    term_postings_.emplace_back();
+    return term_id;
+}
+
+SearchServer::TermId SearchServer::ResolveTerm(string_view word) const {
+    if (compact_index_.frozen) {
+        const size_t term_index = FindTermIndex(word);
+        return term_index == NPOS ? INVALID_TERM : static_cast<TermId>(term_index);
+    }
+    const auto term = term_ids_.find(word);
+    return term == term_ids_.end() ? INVALID_TERM : term->second;
+}
+
+string_view SearchServer::GetTermString(TermId term_id) const {
+    if (compact_index_.frozen) {
+        return compact_index_.terms[term_id];
+    }
+    return term_strings_[term_id];
+}
+
+void SearchServer::InvalidateIdfCache() const {
+    lock_guard guard(idf_cache_mutex_);
+    idf_cache_.clear();
+}
+
+bool SearchServer::IsDocumentRemoved(int document_id) const {
+    return !removed_document_ids_.empty() && removed_document_ids_.count(document_id) > 0;
+}
+
+void SearchServer::RemoveDocument(int document_id) {
+    if (snapshot_) {
+        throw logic_error("Cannot remove documents from a snapshot-backed index"s);
+    }
+    const auto slot_entry = document_slots_.find(document_id);
+    if (slot_entry == document_slots_.end()) {
+        return;
+    }
+    status_slots_[static_cast<size_t>(document_statuses_[slot_entry->second])]
+        [slot_entry->second] = false;
+    document_slots_.erase(slot_entry);
+    document_ids_.erase(
+        find(document_ids_.begin(), document_ids_.end(), document_id));
+    removed_document_ids_.insert(document_id);
+    // The frozen view stays serviceable: queries skip tombstoned postings
+    InvalidateIdfCache();
+    ++index_version_;
+}
+
+void SearchServer::UpdateDocument(int document_id, string_view document,
+    DocumentStatus status, const vector<int>& ratings) {
+    RemoveDocument(document_id);
+    AddDocument(document_id, document, status, ratings);
+}
+
+void SearchServer::PurgeDocumentPostings(int document_id) {
+    for (auto& postings : term_postings_) {
+        postings.erase(document_id);
+    }
+}
+
+void SearchServer::AddDocuments(const vector<DocumentInput>& documents) {
+    if (snapshot_) {
+        throw logic_error("Cannot add documents to a snapshot-backed index"s);
+    }
+    set<int> batch_ids;
+    for (const DocumentInput& document : documents) {
+        if ((document.id < 0) || (document_slots_.count(document.id) > 0) ||
+            !batch_ids.insert(document.id).second) {
+            throw invalid_argument("Invalid document_id"s);
+        }
+    }
+    for (const DocumentInput& document : documents) {
+        if (removed_document_ids_.erase(document.id) > 0) {
+            PurgeDocumentPostings(document.id);
+        }
+    }
+
+    struct Triple {
+        string word;
+        int document_id;
+        double term_freq;
+        // Filled once the word is interned, so forward entries can refer
+        // to the index-owned string
+        string_view interned_word;
+    };
+
+    // Tokenize all documents before touching the index so an invalid word
+    // anywhere in the batch leaves the server unchanged.
+    const size_t worker_count = min<size_t>(
+        max<size_t>(1, thread::hardware_concurrency()), max<size_t>(1, documents.size()));
+    vector<future<vector<Triple>>> partial_triples;
+    partial_triples.reserve(worker_count);
+    for (size_t worker = 0; worker < worker_count; ++worker) {
+        partial_triples.push_back(async(launch::async, [this, worker, worker_count, &documents] {
+            vector<Triple> triples;
+            for (size_t i = worker; i < documents.size(); i += worker_count) {
+                const auto words = SplitIntoWordsNoStop(documents[i].text);
+                const double inv_word_count = 1.0 / words.size();
+                map<string_view, double> word_freqs;
+                for (const string& word : words) {
+                    word_freqs[word] += inv_word_count;
+                }
+                for (const auto& [word, term_freq] : word_freqs) {
+                    triples.push_back({ string(word), documents[i].id, term_freq, {} });
+                }
+            }
+            return triples;
+        }));
+    }
+    vector<Triple> triples;
+    for (auto& partial : partial_triples) {
+        auto chunk = partial.get();
+        triples.insert(triples.end(),
+            make_move_iterator(chunk.begin()), make_move_iterator(chunk.end()));
+    }
+
+    sort(triples.begin(), triples.end(), [](const Triple& lhs, const Triple& rhs) {
+        return tie(lhs.word, lhs.document_id) < tie(rhs.word, rhs.document_id);
+    });
+
+    // One interning lookup per distinct term instead of per occurrence
+    map<int, double>* postings = nullptr;
+    string_view current_word;
+    string_view interned_word;
+    for (Triple& triple : triples) {
+        if (postings == nullptr || triple.word != current_word) {
+            const TermId term_id = InternTerm(triple.word);
+            postings = &term_postings_[term_id];
+            current_word = triple.word;
+            interned_word = term_strings_[term_id];
+        }
+        triple.interned_word = interned_word;
+        postings->emplace_hint(postings->end(), triple.document_id, triple.term_freq);
+    }
+
+    // Regroup by document for the forward index; the stable sort keeps the
+    // word order inside each document's run
+    stable_sort(triples.begin(), triples.end(), [](const Triple& lhs, const Triple& rhs) {
+        return lhs.document_id < rhs.document_id;
+    });
+    unordered_map<int, pair<size_t, size_t>> triple_ranges;
+    for (size_t i = 0; i < triples.size();) {
+        size_t j = i;
+        while (j < triples.size() && triples[j].document_id == triples[i].document_id) {
+            ++j;
+        }
+        triple_ranges.emplace(triples[i].document_id, make_pair(i, j));
+        i = j;
+    }
+
+    for (const DocumentInput& document : documents) {
+        AddDocumentSlot(document.id, document.status, document.ratings);
+        const auto range = triple_ranges.find(document.id);
+        if (range != triple_ranges.end()) {
+            for (size_t i = range->second.first; i < range->second.second; ++i) {
+                forward_entries_.push_back({ triples[i].interned_word, triples[i].term_freq });
+            }
+        }
+        forward_offsets_.push_back(forward_entries_.size());
+        document_ids_.push_back(document.id);
+    }
+    compact_index_.frozen = false;
+    InvalidateIdfCache();
+    ++index_version_;
+}
+
+vector<pair<string_view, SearchServer::TermId>> SearchServer::SortedIndexedTerms() const {
+    vector<pair<string_view, TermId>> terms;
+    terms.reserve(term_ids_.size());
+    for (const auto& [word, term_id] : term_ids_) {
+        if (!term_postings_[term_id].empty()) {
+            terms.push_back({ word, term_id });
+        }
+    }
+    sort(terms.begin(), terms.end());
+    return terms;
+}
+
+void SearchServer::Compact(bool compress_postings) {
+    if (snapshot_) {
+        // The tree-side structures were cleared by LoadIndex; rebuilding
+        // from them would silently replace the served index with an empty one
+        throw logic_error("Cannot compact a snapshot-backed index"s);
+    }
+    if (!removed_document_ids_.empty()) {
+        // Reclaim tombstoned postings before snapshotting the tree
+        for (auto& postings : term_postings_) {
+            for (const int document_id : removed_document_ids_) {
+                postings.erase(document_id);
+            }
+        }
+        removed_document_ids_.clear();
+        InvalidateIdfCache();
+    }
+    if (document_statuses_.size() != document_slots_.size()) {
+        // Stale slots left by removed documents: re-pack the metadata
+        // arrays densely in insertion order
+        vector<DocumentStatus> statuses;
+        vector<int> ratings;
+        vector<RatingStats> rating_stats;
+        vector<WordFrequency> forward_entries;
+        vector<size_t> forward_offsets;
+        statuses.reserve(document_ids_.size());
+        ratings.reserve(document_ids_.size());
+        rating_stats.reserve(document_ids_.size());
+        forward_offsets.reserve(document_ids_.size() + 1);
+        forward_offsets.push_back(0);
+        for (const int document_id : document_ids_) {
+            uint32_t& slot = document_slots_.at(document_id);
+            statuses.push_back(document_statuses_[slot]);
+            ratings.push_back(document_ratings_[slot]);
+            rating_stats.push_back(document_rating_stats_[slot]);
+            forward_entries.insert(forward_entries.end(),
+                forward_entries_.begin() + forward_offsets_[slot],
+                forward_entries_.begin() + forward_offsets_[slot + 1]);
+            forward_offsets.push_back(forward_entries.size());
+            slot = statuses.size() - 1;
+        }
+        document_statuses_ = move(statuses);
+        document_ratings_ = move(ratings);
+        document_rating_stats_ = move(rating_stats);
+        forward_entries_ = move(forward_entries);
+        forward_offsets_ = move(forward_offsets);
+        for (size_t s = 0; s < status_slots_.size(); ++s) {
+            status_slots_[s].assign(document_statuses_.size(), false);
+        }
+        for (size_t slot = 0; slot < document_statuses_.size(); ++slot) {
+            status_slots_[static_cast<size_t>(document_statuses_[slot])][slot] = true;
+        }
+    }
+
+    compact_index_ = CompactIndex{};
+    compact_index_.compressed = compress_postings;
+    const auto sorted_terms = SortedIndexedTerms();
+
+    compact_index_.term_storage.reserve(sorted_terms.size());
+    compact_index_.terms.reserve(sorted_terms.size());
+    compact_index_.offset_storage.reserve(sorted_terms.size() + 1);
+    compact_index_.max_term_freqs.reserve(sorted_terms.size());
+    size_t total_postings = 0;
+    for (const auto& [word, term_id] : sorted_terms) {
+        total_postings += term_postings_[term_id].size();
+    }
+    if (compress_postings) {
+        compact_index_.compressed_byte_offsets.reserve(sorted_terms.size() + 1);
+    }
+    else {
+        compact_index_.posting_storage.reserve(total_postings);
+    }
+    compact_index_.posting_slots.reserve(total_postings);
+
+    size_t posting_count = 0;
+    for (const auto& [word, term_id] : sorted_terms) {
+        compact_index_.term_storage.push_back(string(word));
+        compact_index_.offset_storage.push_back(posting_count);
+        if (compress_postings) {
+            compact_index_.compressed_byte_offsets.push_back(
+                compact_index_.compressed_postings.size());
+        }
+        double max_term_freq = 0.0;
+        uint32_t previous_id = 0;
+        bool first_posting = true;
+        for (const auto& [document_id, term_freq] : term_postings_[term_id]) {
+            if (compress_postings) {
+                const uint32_t id = document_id;
+                EncodeVarint(compact_index_.compressed_postings,
+                    first_posting ? id : id - previous_id);
+                previous_id = id;
+                first_posting = false;
+                // term_freq is in (0, 1]; clamp up so it never quantizes to
+                // zero and a matching document silently scores nothing
+                const uint16_t quantized = static_cast<uint16_t>(
+                    max<long>(1, lround(term_freq * TERM_FREQ_QUANT_SCALE)));
+                compact_index_.compressed_postings.push_back(quantized & 0xFF);
+                compact_index_.compressed_postings.push_back(quantized >> 8);
+            }
+            else {
+                compact_index_.posting_storage.push_back({ document_id, term_freq });
+            }
+            compact_index_.posting_slots.push_back(document_slots_.at(document_id));
+            max_term_freq = max(max_term_freq, term_freq);
+            ++posting_count;
+        }
+        compact_index_.max_term_freqs.push_back(max_term_freq);
+    }
+    compact_index_.offset_storage.push_back(posting_count);
+    if (compress_postings) {
+        compact_index_.compressed_byte_offsets.push_back(
+            compact_index_.compressed_postings.size());
+    }
+    // Views are built only once term_storage is fully populated and stable
+    for (const string& term : compact_index_.term_storage) {
+        compact_index_.terms.push_back(term);
+    }
+    compact_index_.term_offsets = compact_index_.offset_storage.data();
+    compact_index_.postings = compact_index_.posting_storage.data();
+    ComputeCompactIdfs();
+    compact_index_.frozen = true;
+    // Freezing moves term ids into dictionary order, so queries compiled
+    // against the old id space must be recompiled
+    ++index_version_;
+}
+
+void SearchServer::ComputeCompactIdfs() {
+    const double document_count = GetDocumentCount();
+    compact_index_.idfs.clear();
+    compact_index_.idfs.reserve(compact_index_.terms.size());
+    for (size_t i = 0; i < compact_index_.terms.size(); ++i) {
+        const double document_freq =
+            compact_index_.term_offsets[i + 1] - compact_index_.term_offsets[i];
+        compact_index_.idfs.push_back(log(document_count / document_freq));
+    }
+}
+
+void SearchServer::ComputeCompactScoreBounds() {
+    compact_index_.max_term_freqs.clear();
+    compact_index_.max_term_freqs.reserve(compact_index_.terms.size());
+    for (size_t i = 0; i < compact_index_.terms.size(); ++i) {
+        double max_term_freq = 0.0;
+        for (size_t p = compact_index_.term_offsets[i]; p != compact_index_.term_offsets[i + 1]; ++p) {
+            max_term_freq = max(max_term_freq, compact_index_.postings[p].term_freq);
+        }
+        compact_index_.max_term_freqs.push_back(max_term_freq);
+    }
 }
 
-vector<Document> SearchServer::FindTopDocuments(const string& raw_query,
+vector<Document> SearchServer::FindTopDocuments(string_view raw_query,
+    DocumentStatus status) const {
+    return FindTopDocuments(raw_query, status, static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT));
+}
+
+vector<Document> SearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+vector<Document> SearchServer::FindTopDocuments(string_view raw_query,
+    DocumentStatus status, size_t top_k) const {
+    SEARCH_STATS_ADD(queries, 1);
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    Query query(&arena);
+    {
+        SEARCH_STATS_TIMER(parse_timer, parse_ns);
+        query = ParseQuery(raw_query, &arena);
+    }
+
+    vector<Document> matched_documents;
+    {
+        SEARCH_STATS_TIMER(accumulate_timer, accumulate_ns);
+        const auto excluded_documents = CollectExcludedDocuments(query, &arena);
+        pmr::map<int, double> document_to_relevance(&arena);
+        for (const TermId term_id : query.plus_terms) {
+            AccumulateTermRelevanceForStatus(term_id, status, excluded_documents,
+                document_to_relevance);
+        }
+        matched_documents = BuildMatchedDocuments(document_to_relevance);
+    }
+
+    {
+        SEARCH_STATS_TIMER(rank_timer, rank_ns);
+        SelectTopDocuments(matched_documents, top_k);
+    }
+
+    return matched_documents;
+}
+
+void SearchServer::AccumulateTermRelevanceForStatus(TermId term_id, DocumentStatus status,
+    const pmr::vector<int>& excluded_documents,
+    pmr::map<int, double>& document_to_relevance) const {
+    const vector<bool>& status_bitmap = status_slots_[static_cast<size_t>(status)];
+    const auto is_excluded = [&excluded_documents](int document_id) {
+        return !excluded_documents.empty() &&
+            binary_search(excluded_documents.begin(), excluded_documents.end(), document_id);
+    };
+    if (compact_index_.frozen) {
+        const size_t first = compact_index_.term_offsets[term_id];
+        const size_t last = compact_index_.term_offsets[term_id + 1];
+        const double inverse_document_freq = compact_index_.idfs[term_id];
+        SEARCH_STATS_ADD(postings_scanned, last - first);
+        if (compact_index_.compressed) {
+            const unsigned char* bytes = compact_index_.compressed_postings.data() +
+                compact_index_.compressed_byte_offsets[term_id];
+            uint32_t document_id = 0;
+            for (size_t i = first; i != last; ++i) {
+                uint32_t delta;
+                bytes = DecodeVarint(bytes, delta);
+                document_id += delta;
+                const uint16_t quantized = static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+                bytes += 2;
+                if (!status_bitmap[compact_index_.posting_slots[i]] ||
+                    is_excluded(document_id)) {
+                    continue;
+                }
+                document_to_relevance[static_cast<int>(document_id)] +=
+                    (quantized / TERM_FREQ_QUANT_SCALE) * inverse_document_freq;
+            }
+            return;
+        }
+        for (size_t i = first; i != last; ++i) {
+            const Posting& posting = compact_index_.postings[i];
+            // The bit doubles as the tombstone check: removal clears it
+            if (!status_bitmap[compact_index_.posting_slots[i]] ||
+                is_excluded(posting.document_id)) {
+                continue;
+            }
+            document_to_relevance[posting.document_id] +=
+                posting.term_freq * inverse_document_freq;
+        }
+        return;
+    }
+    const auto& postings = term_postings_[term_id];
+    if (postings.empty()) {
+        return;
+    }
+    SEARCH_STATS_ADD(postings_scanned, postings.size());
+    const double inverse_document_freq = ComputeWordInverseDocumentFreq(term_id);
+    for (const auto& [document_id, term_freq] : postings) {
+        const auto slot_entry = document_slots_.find(document_id);
+        if (slot_entry == document_slots_.end() || !status_bitmap[slot_entry->second] ||
+            is_excluded(document_id)) {
+            continue;
+        }
+        document_to_relevance[document_id] += term_freq * inverse_document_freq;
+    }
+}
+
+void SearchServer::SelectTopDocuments(vector<Document>& matched_documents, size_t top_k) {
+    if (matched_documents.size() > top_k) {
+        partial_sort(matched_documents.begin(), matched_documents.begin() + top_k,
+            matched_documents.end(), RanksHigher);
+        matched_documents.resize(top_k);
+    }
+    else {
+        sort(matched_documents.begin(), matched_documents.end(), RanksHigher);
+    }
+}
+
+vector<vector<Document>> SearchServer::FindTopDocumentsBatch(
+    const vector<string_view>& raw_queries, DocumentStatus status) const {
+    return FindTopDocumentsBatch(
+        raw_queries,
+        [status]([[maybe_unused]] int document_id, DocumentStatus document_status,
+            [[maybe_unused]] int rating) { return document_status == status; });
+}
+
+vector<vector<Document>> SearchServer::FindTopDocumentsBatch(
+    const vector<string_view>& raw_queries) const {
+    return FindTopDocumentsBatch(raw_queries, DocumentStatus::ACTUAL);
+}
+
+SearchServer::CompiledQuery SearchServer::CompileQuery(string_view raw_query) const {
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+    CompiledQuery compiled;
+    compiled.text_ = string(raw_query);
+    compiled.plus_terms_.assign(query.plus_terms.begin(), query.plus_terms.end());
+    compiled.minus_terms_.assign(query.minus_terms.begin(), query.minus_terms.end());
+    compiled.index_version_ = index_version_;
+    return compiled;
+}
+
+vector<Document> SearchServer::FindTopDocuments(CompiledQuery& compiled_query,
     DocumentStatus status) const {
     return FindTopDocuments(
+        compiled_query,
+        [status]([[maybe_unused]] int document_id, DocumentStatus document_status,
+            [[maybe_unused]] int rating) { return document_status == status; });
+}
+
+vector<Document> SearchServer::FindTopDocuments(CompiledQuery& compiled_query) const {
+    return FindTopDocuments(compiled_query, DocumentStatus::ACTUAL);
+}
+
+vector<Document> SearchServer::FindTopDocumentsPruned(string_view raw_query,
+    DocumentStatus status, size_t top_k) const {
+    return FindTopDocumentsPruned(
         raw_query,
+        [status]([[maybe_unused]] int document_id, DocumentStatus document_status,
+            [[maybe_unused]] int rating) { return document_status == status; },
+        top_k);
+}
+
+vector<Document> SearchServer::FindTopDocumentsPruned(string_view raw_query) const {
+    return FindTopDocumentsPruned(raw_query, DocumentStatus::ACTUAL);
+}
+
+future<vector<Document>> SearchServer::FindTopDocumentsAsync(string raw_query,
+    DocumentStatus status) const {
+    return FindTopDocumentsAsync(
+        move(raw_query),
         [status]([[maybe_unused]] int document_id, DocumentStatus document_status,
             [[maybe_unused]] int rating) { return document_status == status; });
 }
 
-vector<Document> SearchServer::FindTopDocuments(const string& raw_query) const {
-    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+future<vector<Document>> SearchServer::FindTopDocumentsAsync(string raw_query) const {
+    return FindTopDocumentsAsync(move(raw_query), DocumentStatus::ACTUAL);
+}
+
+ThreadPool& SearchServer::QueryPool() {
+    static ThreadPool pool(max<size_t>(1, thread::hardware_concurrency()));
+    return pool;
+}
+
+SearchCursor SearchServer::FindDocumentsPaged(string_view raw_query, size_t page_size) const {
+    return FindDocumentsPaged(raw_query, DocumentStatus::ACTUAL, page_size);
+}
+
+SearchCursor SearchServer::FindDocumentsPaged(string_view raw_query, DocumentStatus status,
+    size_t page_size) const {
+    if (page_size == 0) {
+        throw invalid_argument("Page size must be positive"s);
+    }
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+    auto matched_documents = FindAllDocuments(
+        query,
+        [status]([[maybe_unused]] int document_id, DocumentStatus document_status,
+            [[maybe_unused]] int rating) { return document_status == status; },
+        &arena);
+    return SearchCursor(std::move(matched_documents), page_size);
 }
 
 int SearchServer::GetDocumentCount() const {
-    return documents_.size();
+    return document_slots_.size();
+}
+
+uint64_t SearchServer::GetIndexVersion() const {
+    return index_version_;
 }
 
 int SearchServer::GetDocumentId(int index) const {
+    if (snapshot_) {
+        if (index < 0 || static_cast<size_t>(index) >= snapshot_document_count_) {
+            throw out_of_range("Document index is out of range"s);
+        }
+        return snapshot_document_ids_[index];
+    }
     return document_ids_.at(index);
 }
 
-tuple<vector<string>, DocumentStatus> SearchServer::MatchDocument(const string& raw_query,
-    int document_id) const {
-    const auto query = ParseQuery(raw_query);
+void SearchServer::SaveIndex(const string& path) const {
+    if (snapshot_) {
+        // Serialization reads the tree-side structures LoadIndex cleared;
+        // writing from them would produce a corrupt, empty snapshot
+        throw logic_error("Cannot save a snapshot-backed index"s);
+    }
+    if (!removed_document_ids_.empty()) {
+        throw logic_error("Call Compact() before SaveIndex to reclaim removed documents"s);
+    }
+    ofstream output(path, ios::binary);
+    if (!output) {
+        throw runtime_error("Cannot open "s + path + " for writing"s);
+    }
+    const auto sorted_terms = SortedIndexedTerms();
 
-    vector<string> matched_words;
-    for (const string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.document_count = GetDocumentCount();
+    header.term_count = sorted_terms.size();
+    for (const auto& [word, term_id] : sorted_terms) {
+        header.posting_count += term_postings_[term_id].size();
+        header.term_char_count += word.size();
+    }
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    size_t written = sizeof(header);
+
+    vector<pair<int, uint32_t>> sorted_slots(document_slots_.begin(), document_slots_.end());
+    sort(sorted_slots.begin(), sorted_slots.end());
+    for (const auto& [id, slot] : sorted_slots) {
+        const DocumentEntry entry{ id, document_ratings_[slot], document_statuses_[slot],
+            document_rating_stats_[slot] };
+        output.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        written += sizeof(entry);
+    }
+    output.write(reinterpret_cast<const char*>(document_ids_.data()),
+        document_ids_.size() * sizeof(int));
+    written += document_ids_.size() * sizeof(int);
+
+    WritePadding(output, written, sizeof(size_t));
+    written = AlignUp(written, sizeof(size_t));
+    size_t posting_offset = 0;
+    for (const auto& [word, term_id] : sorted_terms) {
+        output.write(reinterpret_cast<const char*>(&posting_offset), sizeof(posting_offset));
+        posting_offset += term_postings_[term_id].size();
+    }
+    output.write(reinterpret_cast<const char*>(&posting_offset), sizeof(posting_offset));
+    written += (header.term_count + 1) * sizeof(size_t);
+
+    for (const auto& [word, term_id] : sorted_terms) {
+        const uint32_t length = word.size();
+        output.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+    written += header.term_count * sizeof(uint32_t);
+    for (const auto& [word, term_id] : sorted_terms) {
+        output.write(word.data(), word.size());
+    }
+    written += header.term_char_count;
+
+    WritePadding(output, written, alignof(Posting));
+    for (const auto& [word, term_id] : sorted_terms) {
+        for (const auto& [document_id, term_freq] : term_postings_[term_id]) {
+            const Posting posting{ document_id, term_freq };
+            output.write(reinterpret_cast<const char*>(&posting), sizeof(posting));
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.push_back(word);
+    }
+
+    if (!output) {
+        throw runtime_error("Failed to write index snapshot to "s + path);
+    }
+}
+
+void SearchServer::LoadIndex(const string& path) {
+    shared_ptr<void> mapping;
+    size_t mapped_size = 0;
+#ifdef SEARCH_SERVER_HAS_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Cannot open "s + path + " for reading"s);
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw runtime_error("Cannot stat "s + path);
+    }
+    mapped_size = file_stat.st_size;
+    void* data = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw runtime_error("Cannot map "s + path);
+    }
+    mapping = shared_ptr<void>(data,
+        [mapped_size](void* p) { munmap(p, mapped_size); });
+#else
+    // No mmap available: fall back to one contiguous heap buffer, which is
+    // served through exactly the same pointers.
+    ifstream input(path, ios::binary | ios::ate);
+    if (!input) {
+        throw runtime_error("Cannot open "s + path + " for reading"s);
+    }
+    mapped_size = input.tellg();
+    input.seekg(0);
+    mapping = shared_ptr<void>(operator new(mapped_size),
+        [](void* p) { operator delete(p); });
+    input.read(static_cast<char*>(mapping.get()), mapped_size);
+    if (!input) {
+        throw runtime_error("Failed to read index snapshot from "s + path);
+    }
+#endif
+
+    const char* base = static_cast<const char*>(mapping.get());
+    if (mapped_size < sizeof(SnapshotHeader) ||
+        memcmp(base, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw runtime_error(path + " is not an index snapshot"s);
+    }
+    SnapshotHeader header;
+    memcpy(&header, base, sizeof(header));
+
+    size_t offset = sizeof(header);
+    const auto* document_entries = reinterpret_cast<const DocumentEntry*>(base + offset);
+    offset += header.document_count * sizeof(DocumentEntry);
+    const int* document_ids = reinterpret_cast<const int*>(base + offset);
+    offset += header.document_count * sizeof(int);
+
+    offset = AlignUp(offset, sizeof(size_t));
+    const auto* term_offsets = reinterpret_cast<const size_t*>(base + offset);
+    offset += (header.term_count + 1) * sizeof(size_t);
+    const auto* term_lengths = reinterpret_cast<const uint32_t*>(base + offset);
+    offset += header.term_count * sizeof(uint32_t);
+    const char* term_chars = base + offset;
+    offset += header.term_char_count;
+
+    offset = AlignUp(offset, alignof(Posting));
+    const auto* postings = reinterpret_cast<const Posting*>(base + offset);
+    offset += header.posting_count * sizeof(Posting);
+    if (offset > mapped_size) {
+        throw runtime_error(path + " is truncated"s);
+    }
+
+    CompactIndex index;
+    index.terms.reserve(header.term_count);
+    const char* term_char = term_chars;
+    for (size_t i = 0; i < header.term_count; ++i) {
+        index.terms.emplace_back(term_char, term_lengths[i]);
+        term_char += term_lengths[i];
+    }
+    index.term_offsets = term_offsets;
+    index.postings = postings;
+    index.frozen = true;
+
+    // Unpack document metadata into the slot arrays; entries are sorted by
+    // id, so the slot of an id is its position among the entries.
+    unordered_map<int, uint32_t> slots;
+    vector<DocumentStatus> statuses;
+    vector<int> ratings;
+    vector<RatingStats> rating_stats;
+    slots.reserve(header.document_count);
+    statuses.reserve(header.document_count);
+    ratings.reserve(header.document_count);
+    rating_stats.reserve(header.document_count);
+    for (size_t i = 0; i < header.document_count; ++i) {
+        slots.emplace(document_entries[i].id, static_cast<uint32_t>(i));
+        statuses.push_back(document_entries[i].status);
+        ratings.push_back(document_entries[i].rating);
+        rating_stats.push_back(document_entries[i].rating_stats);
+    }
+    index.posting_slots.reserve(header.posting_count);
+    const DocumentEntry* entries_end = document_entries + header.document_count;
+    for (size_t i = 0; i < header.posting_count; ++i) {
+        const DocumentEntry* entry = lower_bound(document_entries, entries_end,
+            postings[i].document_id,
+            [](const DocumentEntry& lhs, int id) { return lhs.id < id; });
+        if (entry == entries_end || entry->id != postings[i].document_id) {
+            throw runtime_error(path + " references an unknown document"s);
         }
+        index.posting_slots.push_back(entry - document_entries);
     }
-    for (const string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+
+    // Rebuild the forward index by inverting the term-major postings;
+    // terms are visited in dictionary order, so every document's entries
+    // come out already sorted by word. The views refer into the snapshot.
+    vector<size_t> forward_offsets(header.document_count + 1, 0);
+    for (const uint32_t slot : index.posting_slots) {
+        ++forward_offsets[slot + 1];
+    }
+    for (size_t slot = 1; slot <= header.document_count; ++slot) {
+        forward_offsets[slot] += forward_offsets[slot - 1];
+    }
+    vector<WordFrequency> forward_entries(header.posting_count);
+    vector<size_t> forward_cursors(forward_offsets.begin(), forward_offsets.end() - 1);
+    for (size_t i = 0; i < header.term_count; ++i) {
+        for (size_t p = term_offsets[i]; p != term_offsets[i + 1]; ++p) {
+            forward_entries[forward_cursors[index.posting_slots[p]]++] =
+                { index.terms[i], postings[p].term_freq };
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+    }
+
+    term_strings_.clear();
+    term_ids_.clear();
+    term_postings_.clear();
+    document_ids_.clear();
+    removed_document_ids_.clear();
+    document_slots_ = move(slots);
+    document_statuses_ = move(statuses);
+    document_ratings_ = move(ratings);
+    document_rating_stats_ = move(rating_stats);
+    forward_entries_ = move(forward_entries);
+    forward_offsets_ = move(forward_offsets);
+    for (size_t s = 0; s < status_slots_.size(); ++s) {
+        status_slots_[s].assign(document_statuses_.size(), false);
+    }
+    for (size_t slot = 0; slot < document_statuses_.size(); ++slot) {
+        status_slots_[static_cast<size_t>(document_statuses_[slot])][slot] = true;
+    }
+    compact_index_ = std::move(index);
+    snapshot_ = std::move(mapping);
+    snapshot_document_count_ = header.document_count;
+    snapshot_document_ids_ = document_ids;
+    ComputeCompactIdfs();
+    ComputeCompactScoreBounds();
+    InvalidateIdfCache();
+    ++index_version_;
+}
+
+tuple<vector<string_view>, DocumentStatus> SearchServer::MatchDocument(string_view raw_query,
+    int document_id) const {
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+
+    const uint32_t slot = document_slots_.at(document_id);
+    vector<string_view> matched_words;
+    for (const TermId term_id : query.plus_terms) {
+        // The view refers to the word owned by the index, so it outlives the query
+        const string_view word = GetTermString(term_id);
+        if (DocumentContainsWord(slot, word)) {
+            matched_words.push_back(word);
+        }
+    }
+    for (const TermId term_id : query.minus_terms) {
+        if (DocumentContainsWord(slot, GetTermString(term_id))) {
             matched_words.clear();
             break;
         }
     }
-    return { matched_words, documents_.at(document_id).status };
+    sort(matched_words.begin(), matched_words.end());
+    return { matched_words, document_statuses_[slot] };
+}
+
+tuple<vector<string_view>, DocumentStatus> SearchServer::MatchDocument(
+    const execution::sequenced_policy&, string_view raw_query, int document_id) const {
+    return MatchDocument(raw_query, document_id);
+}
+
+tuple<vector<string_view>, DocumentStatus> SearchServer::MatchDocument(
+    const execution::parallel_policy&, string_view raw_query, int document_id) const {
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+
+    const uint32_t slot = document_slots_.at(document_id);
+    const auto term_matches_document = [this, slot](TermId term_id) {
+        return DocumentContainsWord(slot, GetTermString(term_id));
+    };
+
+    if (any_of(query.minus_terms.begin(), query.minus_terms.end(), term_matches_document)) {
+        return { vector<string_view>{}, document_statuses_[slot] };
+    }
+
+    vector<string_view> matched_words(query.plus_terms.size());
+    transform(query.plus_terms.begin(), query.plus_terms.end(), matched_words.begin(),
+        [this, &term_matches_document](TermId term_id) -> string_view {
+            if (!term_matches_document(term_id)) {
+                return {};
+            }
+            // Return the view of the index-owned word so it outlives the query
+            return GetTermString(term_id);
+        });
+    matched_words.erase(
+        remove(matched_words.begin(), matched_words.end(), string_view{}),
+        matched_words.end());
+    sort(matched_words.begin(), matched_words.end());
+    return { matched_words, GetDocumentData(document_id).status };
+}
+
+vector<SearchServer::DocumentMatch> SearchServer::MatchDocuments(string_view raw_query) const {
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+
+    const auto excluded_slots = CollectExcludedSlots(query);
+    vector<vector<TermId>> slot_terms(document_statuses_.size());
+    for (const TermId term_id : query.plus_terms) {
+        ForEachPosting(term_id, [&](int document_id, double) {
+            const auto slot = document_slots_.find(document_id);
+            if (slot != document_slots_.end() && !excluded_slots[slot->second]) {
+                slot_terms[slot->second].push_back(term_id);
+            }
+        });
+    }
+    return BuildDocumentMatches(slot_terms);
+}
+
+vector<SearchServer::DocumentMatch> SearchServer::MatchDocuments(
+    const execution::sequenced_policy&, string_view raw_query) const {
+    return MatchDocuments(raw_query);
+}
+
+vector<SearchServer::DocumentMatch> SearchServer::MatchDocuments(
+    const execution::parallel_policy&, string_view raw_query) const {
+    pmr::monotonic_buffer_resource arena(QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+
+    const auto excluded_slots = CollectExcludedSlots(query);
+    const size_t worker_count = min<size_t>(
+        max<size_t>(1, thread::hardware_concurrency()), query.plus_terms.size());
+    vector<future<vector<pair<uint32_t, TermId>>>> partial_matches;
+    partial_matches.reserve(worker_count);
+    for (size_t worker = 0; worker < worker_count; ++worker) {
+        partial_matches.push_back(async(launch::async,
+            [this, worker, worker_count, &query, &excluded_slots] {
+                vector<pair<uint32_t, TermId>> local_matches;
+                for (size_t i = worker; i < query.plus_terms.size(); i += worker_count) {
+                    const TermId term_id = query.plus_terms[i];
+                    ForEachPosting(term_id, [&](int document_id, double) {
+                        const auto slot = document_slots_.find(document_id);
+                        if (slot != document_slots_.end() && !excluded_slots[slot->second]) {
+                            local_matches.emplace_back(slot->second, term_id);
+                        }
+                    });
+                }
+                return local_matches;
+            }));
+    }
+
+    vector<vector<TermId>> slot_terms(document_statuses_.size());
+    for (auto& partial : partial_matches) {
+        for (const auto& [slot, term_id] : partial.get()) {
+            slot_terms[slot].push_back(term_id);
+        }
+    }
+    return BuildDocumentMatches(slot_terms);
+}
+
+vector<bool> SearchServer::CollectExcludedSlots(const Query& query) const {
+    vector<bool> excluded_slots(document_statuses_.size(), false);
+    for (const TermId term_id : query.minus_terms) {
+        ForEachPosting(term_id, [&](int document_id, double) {
+            const auto slot = document_slots_.find(document_id);
+            if (slot != document_slots_.end()) {
+                excluded_slots[slot->second] = true;
+            }
+        });
+    }
+    return excluded_slots;
+}
+
+vector<SearchServer::DocumentMatch> SearchServer::BuildDocumentMatches(
+    const vector<vector<TermId>>& slot_terms) const {
+    vector<pair<int, uint32_t>> ordered_slots;
+    for (const auto& [document_id, slot] : document_slots_) {
+        if (!slot_terms[slot].empty()) {
+            ordered_slots.emplace_back(document_id, slot);
+        }
+    }
+    sort(ordered_slots.begin(), ordered_slots.end());
+
+    vector<DocumentMatch> matches;
+    matches.reserve(ordered_slots.size());
+    for (const auto& [document_id, slot] : ordered_slots) {
+        DocumentMatch match{ document_id, {}, document_statuses_[slot] };
+        match.words.reserve(slot_terms[slot].size());
+        for (const TermId term_id : slot_terms[slot]) {
+            // Views refer to index-owned words, matching MatchDocument
+            match.words.push_back(GetTermString(term_id));
+        }
+        sort(match.words.begin(), match.words.end());
+        matches.push_back(move(match));
+    }
+    return matches;
+}
+
+SearchStats SearchServer::GetStats() {
+#ifndef SEARCH_SERVER_DISABLE_STATS
+    return stats_internal::AggregateSlots();
+#else
+    return {};
+#endif
+}
+
+void SearchServer::ResetStats() {
+#ifndef SEARCH_SERVER_DISABLE_STATS
+    stats_internal::ResetSlots();
+#endif
+}
+
+vector<Document> SearchServer::BuildMatchedDocuments(
+    const pmr::map<int, double>& document_to_relevance) const {
+    SEARCH_STATS_ADD(candidate_documents, document_to_relevance.size());
+    vector<Document> matched_documents;
+    matched_documents.reserve(document_to_relevance.size());
+    for (const auto& [document_id, relevance] : document_to_relevance) {
+        matched_documents.push_back(
+            { document_id, relevance, GetDocumentData(document_id).rating });
+    }
+    return matched_documents;
 }
 
-bool SearchServer::IsStopWord(const string& word) const {
-    return stop_words_.count(word) > 0;
+bool SearchServer::IsStopWord(string_view word) const {
+    return binary_search(stop_words_.begin(), stop_words_.end(), word, less<>{});
 }
 
-bool SearchServer::IsValidWord(const string& word) {
+bool SearchServer::IsValidWord(string_view word) {
     // A valid word must not contain special characters
     return none_of(word.begin(), word.end(),
         [](char c) { return c >= '\0' && c < ' '; });
 }
 
-vector<string> SearchServer::SplitIntoWordsNoStop(const string& text) const {
+vector<string> SearchServer::SplitIntoWordsNoStop(string_view text) const {
     vector<string> words;
-    for (const string& word : SplitIntoWords(text)) {
+    for (string_view word : SplitIntoWords(text)) {
         if (!IsValidWord(word)) {
-            throw invalid_argument("Word "s + word + " is invalid"s);
+            throw invalid_argument("Word "s + string(word) + " is invalid"s);
         }
         if (!IsStopWord(word)) {
-            words.push_back(word);
+            words.push_back(string(word));
         }
     }
     return words;
@@ -101,39 +1076,200 @@ int SearchServer::ComputeAverageRating(const vector<int>& ratings) {
     return rating_sum / static_cast<int>(ratings.size());
 }
 
-SearchServer::QueryWord SearchServer::ParseQueryWord(const string& text) const {
+SearchServer::QueryWord SearchServer::ParseQueryWord(string_view text) const {
     if (text.empty()) {
         throw invalid_argument("Query word is empty"s);
     }
-    string word = text;
+    string_view word = text;
     bool is_minus = false;
     if (word[0] == '-') {
         is_minus = true;
-        word = word.substr(1);
+        word.remove_prefix(1);
     }
     if (word.empty() || word[0] == '-' || !IsValidWord(word)) {
-        throw invalid_argument("Query word "s + text + " is invalid");
+        throw invalid_argument("Query word "s + string(text) + " is invalid");
     }
 
     return { word, is_minus, IsStopWord(word) };
 }
 
-SearchServer::Query SearchServer::ParseQuery(const string& text) const {
-    Query result;
-    for (const string& word : SplitIntoWords(text)) {
+vector<char>& SearchServer::QueryArenaBuffer() {
+    static thread_local vector<char> buffer(QUERY_ARENA_INITIAL_BYTES);
+    return buffer;
+}
+
+SearchServer::Query SearchServer::ParseQuery(string_view text, pmr::memory_resource* arena) const {
+    Query result(arena);
+    for (string_view word : SplitIntoWords(text)) {
         const auto query_word = ParseQueryWord(word);
         if (!query_word.is_stop) {
+            const TermId term_id = ResolveTerm(query_word.data);
+            if (term_id == INVALID_TERM) {
+                // Words outside the index cannot match any document
+                continue;
+            }
             if (query_word.is_minus) {
-                result.minus_words.insert(query_word.data);
+                result.minus_terms.push_back(term_id);
             }
             else {
-                result.plus_words.insert(query_word.data);
+                result.plus_terms.push_back(term_id);
             }
         }
     }
+    // Queries are typically a handful of terms, so a flat sort+unique pass
+    // beats per-token tree inserts; skip it outright for the common empty
+    // or single-term case (minus terms in particular are usually absent)
+    for (auto* terms : { &result.plus_terms, &result.minus_terms }) {
+        if (terms->size() < 2) {
+            continue;
+        }
+        sort(terms->begin(), terms->end());
+        terms->erase(unique(terms->begin(), terms->end()), terms->end());
+    }
     return result;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(const string& word) const {
-    return log(GetDocumentCount() / static_cast<double>(word_to_document_freqs_.at(word).size()));
-}
\ No newline at end of file
+pmr::vector<int> SearchServer::CollectExcludedDocuments(const Query& query,
+    pmr::memory_resource* arena) const {
+    pmr::vector<int> excluded_documents(arena);
+    for (const TermId term_id : query.minus_terms) {
+        if (compact_index_.frozen && compact_index_.compressed) {
+            const unsigned char* bytes = compact_index_.compressed_postings.data() +
+                compact_index_.compressed_byte_offsets[term_id];
+            uint32_t document_id = 0;
+            const size_t count = compact_index_.term_offsets[term_id + 1] -
+                compact_index_.term_offsets[term_id];
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t delta;
+                bytes = DecodeVarint(bytes, delta);
+                document_id += delta;
+                bytes += 2;
+                excluded_documents.push_back(document_id);
+            }
+        }
+        else if (compact_index_.frozen) {
+            const auto [first, last] = GetCompactPostings(term_id);
+            for (const Posting* posting = first; posting != last; ++posting) {
+                excluded_documents.push_back(posting->document_id);
+            }
+        }
+        else {
+            for (const auto& [document_id, _] : term_postings_[term_id]) {
+                excluded_documents.push_back(document_id);
+            }
+        }
+    }
+    sort(excluded_documents.begin(), excluded_documents.end());
+    excluded_documents.erase(
+        unique(excluded_documents.begin(), excluded_documents.end()),
+        excluded_documents.end());
+    return excluded_documents;
+}
+
+double SearchServer::ComputeWordInverseDocumentFreq(TermId term_id) const {
+    if (compact_index_.frozen) {
+        return compact_index_.idfs[term_id];
+    }
+    {
+        lock_guard guard(idf_cache_mutex_);
+        const auto cached = idf_cache_.find(term_id);
+        if (cached != idf_cache_.end()) {
+            return cached->second;
+        }
+    }
+    const double idf =
+        log(GetDocumentCount() / static_cast<double>(GetWordDocumentFreq(term_id)));
+    lock_guard guard(idf_cache_mutex_);
+    idf_cache_.emplace(term_id, idf);
+    return idf;
+}
+
+size_t SearchServer::GetWordDocumentFreq(TermId term_id) const {
+    if (compact_index_.frozen) {
+        return compact_index_.term_offsets[term_id + 1] - compact_index_.term_offsets[term_id];
+    }
+    return term_postings_[term_id].size();
+}
+
+size_t SearchServer::FindTermIndex(string_view word) const {
+    const auto term = lower_bound(compact_index_.terms.begin(), compact_index_.terms.end(), word);
+    if (term == compact_index_.terms.end() || *term != word) {
+        return NPOS;
+    }
+    return term - compact_index_.terms.begin();
+}
+
+pair<const SearchServer::Posting*, const SearchServer::Posting*>
+SearchServer::GetCompactPostings(TermId term_id) const {
+    return { compact_index_.postings + compact_index_.term_offsets[term_id],
+             compact_index_.postings + compact_index_.term_offsets[term_id + 1] };
+}
+
+SearchServer::DocumentData SearchServer::GetDocumentData(int document_id) const {
+    const uint32_t slot = document_slots_.at(document_id);
+    return { document_ratings_[slot], document_statuses_[slot] };
+}
+
+SearchServer::RatingStats SearchServer::GetRatingStats(int document_id) const {
+    const auto slot = document_slots_.find(document_id);
+    if (slot == document_slots_.end()) {
+        throw out_of_range("Document with id "s + to_string(document_id) + " is not present"s);
+    }
+    return document_rating_stats_[slot->second];
+}
+
+void SearchServer::AddDocumentSlot(int document_id, DocumentStatus status,
+    const vector<int>& ratings) {
+    RatingStats stats;
+    stats.count = static_cast<int32_t>(ratings.size());
+    for (const int rating : ratings) {
+        stats.sum += rating;
+        stats.sum_squares += static_cast<int64_t>(rating) * rating;
+    }
+    document_statuses_.push_back(status);
+    document_ratings_.push_back(stats.count == 0
+        ? 0 : static_cast<int>(stats.sum / stats.count));
+    document_rating_stats_.push_back(stats);
+    for (size_t s = 0; s < status_slots_.size(); ++s) {
+        status_slots_[s].push_back(static_cast<DocumentStatus>(s) == status);
+    }
+    document_slots_.emplace(document_id, document_statuses_.size() - 1);
+}
+
+bool SearchServer::DocumentContainsWord(uint32_t slot, string_view word) const {
+    const WordFrequency* first = forward_entries_.data() + forward_offsets_[slot];
+    const WordFrequency* last = forward_entries_.data() + forward_offsets_[slot + 1];
+    const WordFrequency* entry = lower_bound(first, last, word,
+        [](const WordFrequency& lhs, string_view w) { return lhs.word < w; });
+    return entry != last && entry->word == word;
+}
+
+pair<const SearchServer::WordFrequency*, const SearchServer::WordFrequency*>
+SearchServer::GetWordFrequencies(int document_id) const {
+    const auto slot = document_slots_.find(document_id);
+    if (slot == document_slots_.end()) {
+        return { nullptr, nullptr };
+    }
+    return { forward_entries_.data() + forward_offsets_[slot->second],
+             forward_entries_.data() + forward_offsets_[slot->second + 1] };
+}
+
+void SearchServer::AppendForwardEntries(vector<TermId> occurrence_terms) {
+    const size_t first_entry = forward_entries_.size();
+    if (!occurrence_terms.empty()) {
+        sort(occurrence_terms.begin(), occurrence_terms.end());
+        const double inv_word_count = 1.0 / occurrence_terms.size();
+        for (size_t i = 0; i < occurrence_terms.size();) {
+            size_t j = i;
+            while (j < occurrence_terms.size() && occurrence_terms[j] == occurrence_terms[i]) {
+                ++j;
+            }
+            forward_entries_.push_back({ string_view(term_strings_[occurrence_terms[i]]),
+                (j - i) * inv_word_count });
+            i = j;
+        }
+        sort(forward_entries_.begin() + first_entry, forward_entries_.end(),
+            [](const WordFrequency& lhs, const WordFrequency& rhs) { return lhs.word < rhs.word; });
+    }
+    forward_offsets_.push_back(forward_entries_.size());
+}
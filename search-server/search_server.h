@@ -1,9 +1,26 @@
 #pragma once
 #include "document.h"
+#include "search_cursor.h"
+#include "search_stats.h"
 #include "string_processing.h"
+#include "thread_pool.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <execution>
+#include <future>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include <map>
 #include <set>
@@ -11,73 +28,560 @@
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
 
 class SearchServer {
+    // Dense id handed out by the interning term dictionary. While the
+    // compact view is frozen, ids are positions in its sorted dictionary;
+    // otherwise they are interning order. Queries resolve words to ids once
+    // and the hot loops compare integers, never strings.
+    using TermId = std::uint32_t;
+    static constexpr TermId INVALID_TERM = static_cast<TermId>(-1);
+
 public:
     template <typename StringContainer>
     explicit SearchServer(const StringContainer& stop_words);
+    explicit SearchServer(std::string_view stop_words_text);
     explicit SearchServer(const std::string& stop_words_text);
     SearchServer() = default;
 
-    void AddDocument(int document_id, const std::string& document,
+    void AddDocument(int document_id, std::string_view document,
+        DocumentStatus status, const std::vector<int>& ratings);
+
+    // Retires a document without rebuilding the index: its metadata goes
+    // away immediately, while its postings are tombstoned and skipped by
+    // queries until the next Compact() reclaims them. Unknown ids are
+    // ignored so deletes are idempotent.
+    void RemoveDocument(int document_id);
+
+    // Replaces a document's text, status and ratings in place.
+    void UpdateDocument(int document_id, std::string_view document,
         DocumentStatus status, const std::vector<int>& ratings);
 
+    struct DocumentInput {
+        int id;
+        std::string text;
+        DocumentStatus status;
+        std::vector<int> ratings;
+    };
+
+    // Compact summary of a document's raw ratings, kept at AddDocument time
+    // so ranking signals beyond the average (count, variance, confidence
+    // weighting) can be computed without re-ingesting the corpus.
+    struct RatingStats {
+        std::int32_t count = 0;
+        std::int64_t sum = 0;
+        std::int64_t sum_squares = 0;
+    };
+
+    // Bulk-loads a batch of documents: tokenizes them in parallel, collects
+    // (term, document, freq) triples in one flat buffer, sorts it once and
+    // builds the postings lists in a single ordered pass instead of one map
+    // insertion per word occurrence. Either the whole batch is indexed or,
+    // if any document is invalid, none of it is.
+    void AddDocuments(const std::vector<DocumentInput>& documents);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentPredicate document_predicate) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    // Overloads taking an explicit result count instead of
+    // MAX_RESULT_DOCUMENT_COUNT. Only the top_k best documents are ordered,
+    // via bounded selection rather than a full sort.
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentPredicate document_predicate, size_t top_k) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentStatus status, size_t top_k) const;
+
+    template <typename ExecutionPolicy, typename DocumentPredicate,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate) const;
+
+    template <typename ExecutionPolicy, typename DocumentPredicate,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, size_t top_k) const;
+
+    template <typename ExecutionPolicy,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentStatus status) const;
+
+    template <typename ExecutionPolicy,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const;
+
+    // A query parsed and resolved once, executable repeatedly with zero
+    // parse cost; built by CompileQuery. Holds the term ids of the index
+    // representation current at compile time along with the index version,
+    // so the executing overload can detect staleness and recompile from the
+    // retained query text in place.
+    class CompiledQuery {
+    public:
+        const std::string& Text() const {
+            return text_;
+        }
+
+    private:
+        friend class SearchServer;
+        std::string text_;
+        std::vector<TermId> plus_terms_;
+        std::vector<TermId> minus_terms_;
+        std::uint64_t index_version_ = 0;
+    };
+
+    CompiledQuery CompileQuery(std::string_view raw_query) const;
+
+    // Executes a precompiled query; recompiles it in place first if the
+    // index has changed since it was built, which is why the query is taken
+    // by non-const reference.
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(CompiledQuery& compiled_query,
+        DocumentPredicate document_predicate,
+        size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(CompiledQuery& compiled_query,
+        DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocuments(CompiledQuery& compiled_query) const;
+
+    // MaxScore-pruned top-K evaluation over the frozen compact index: terms
+    // carry a precomputed score upper bound (max term_freq * idf), and
+    // documents whose bound sum cannot beat the current K-th best relevance
+    // are skipped without scoring. Results match the exhaustive overloads
+    // exactly. Falls back to the exhaustive path while the index is
+    // unfrozen, since the tree postings carry no bounds.
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsPruned(std::string_view raw_query,
+        DocumentPredicate document_predicate,
+        size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocumentsPruned(std::string_view raw_query,
+        DocumentStatus status, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocumentsPruned(std::string_view raw_query) const;
+
+    // Rating summary of the document; throws std::out_of_range for unknown
+    // ids.
+    RatingStats GetRatingStats(int document_id) const;
+
+    // Ranking-formula hook: matches like the ACTUAL-status overload but
+    // orders results by scoring(document, rating_stats) descending (ties by
+    // ascending id) instead of the built-in relevance/rating comparator.
+    // Lets ranking experiments combine relevance with the retained rating
+    // statistics as a code change instead of a re-ingest.
+    template <typename ScoringFunction>
+    std::vector<Document> FindTopDocumentsRanked(std::string_view raw_query,
+        ScoringFunction scoring, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    // Executes a batch of related queries in one pass over the index: every
+    // query is parsed up front, plus terms are grouped across the batch, and
+    // each shared term's postings are traversed exactly once with its
+    // contribution scattered into all subscribing queries' accumulators.
+    // Results per query are identical to running FindTopDocuments in a loop;
+    // the win is proportional to how many terms the queries share.
+    template <typename DocumentPredicate>
+    std::vector<std::vector<Document>> FindTopDocumentsBatch(
+        const std::vector<std::string_view>& raw_queries,
+        DocumentPredicate document_predicate,
+        size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<std::vector<Document>> FindTopDocumentsBatch(
+        const std::vector<std::string_view>& raw_queries, DocumentStatus status) const;
+
+    std::vector<std::vector<Document>> FindTopDocumentsBatch(
+        const std::vector<std::string_view>& raw_queries) const;
+
+    // Asynchronous variants running on the shared query pool; the future
+    // carries exactly what the blocking call would return. The query text is
+    // taken by value so it outlives the caller's buffer. As with the
+    // blocking calls, queries racing index mutations need external
+    // synchronization (see ConcurrentSearchServer).
     template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(const std::string& raw_query,
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query,
         DocumentPredicate document_predicate) const;
 
-    std::vector<Document> FindTopDocuments(const std::string& raw_query,
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query,
         DocumentStatus status) const;
 
-    std::vector<Document> FindTopDocuments(const std::string& raw_query) const;
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query) const;
+
+    // Process-wide worker pool, sized to hardware_concurrency, that executes
+    // the *Async entry points; shared so concurrent callers are co-scheduled
+    // instead of spawning a thread per query.
+    static ThreadPool& QueryPool();
+
+    // Lazy paginated execution: matching and relevance accumulation run
+    // once, but ranking happens page by page inside the returned cursor, so
+    // deep pages never require re-running the query with a larger top_k.
+    SearchCursor FindDocumentsPaged(std::string_view raw_query, size_t page_size) const;
+
+    SearchCursor FindDocumentsPaged(std::string_view raw_query, DocumentStatus status,
+        size_t page_size) const;
 
     int GetDocumentCount() const;
 
     int GetDocumentId(int index) const;
 
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query,
+    // Aggregated engine counters and stage timings across all threads since
+    // process start (or the last ResetStats); see search_stats.h. Returns
+    // zeros when probes are compiled out with SEARCH_SERVER_DISABLE_STATS.
+    static SearchStats GetStats();
+
+    static void ResetStats();
+
+    // Monotonic counter bumped by every mutation that can change query
+    // results; lets result caches detect staleness with one comparison.
+    uint64_t GetIndexVersion() const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query,
         int document_id) const;
 
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        const std::execution::sequenced_policy&, std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        const std::execution::parallel_policy&, std::string_view raw_query, int document_id) const;
+
+    // One document's match against a query: the query words found in the
+    // document (sorted, views into index-owned strings) and its status.
+    struct DocumentMatch {
+        int document_id;
+        std::vector<std::string_view> words;
+        DocumentStatus status;
+    };
+
+    // Matches the query against the whole corpus at once: the query is
+    // parsed a single time and each term's postings list is walked exactly
+    // once, so a full relevance audit costs one linear postings merge
+    // instead of a MatchDocument call per document. Returns an entry for
+    // every document containing at least one plus word and no minus words,
+    // ordered by ascending document id.
+    std::vector<DocumentMatch> MatchDocuments(std::string_view raw_query) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::sequenced_policy&,
+        std::string_view raw_query) const;
+
+    // Parallel variant striding the plus-word postings walks across workers.
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::parallel_policy&,
+        std::string_view raw_query) const;
+
+    // One forward-index entry: an indexed word of the document and its
+    // in-document frequency (occurrences / document length).
+    struct WordFrequency {
+        std::string_view word;
+        double frequency;
+    };
+
+    // The document's words with their frequencies as a contiguous
+    // [first, last) range sorted by word; the views stay valid until the
+    // index is mutated. Unknown document ids yield an empty range.
+    std::pair<const WordFrequency*, const WordFrequency*> GetWordFrequencies(
+        int document_id) const;
+
+    // Builds the flat postings-list representation of the index and reclaims
+    // the postings of removed documents. Call after bulk loading or a batch
+    // of removals; a subsequent AddDocument invalidates the flat view and
+    // queries fall back to the tree-based index until the next Compact().
+    // With compress_postings set, postings are stored delta-varint encoded
+    // with 16-bit quantized term frequencies instead of flat structs,
+    // shrinking resident postings memory at the cost of streaming decode
+    // during scoring and slightly quantized relevance values. Throws
+    // logic_error on a snapshot-backed server, which is already flat and
+    // has no tree index to rebuild from.
+    void Compact(bool compress_postings = false);
+
+    // Serializes the whole index (terms, postings, document data) into a
+    // contiguous binary snapshot at path. Throws logic_error on a
+    // snapshot-backed server, whose tree-side structures are gone; the
+    // original snapshot file already holds that index.
+    void SaveIndex(const std::string& path) const;
+
+    // Memory-maps a snapshot produced by SaveIndex and serves queries
+    // directly from the mapping: postings, term characters and document data
+    // stay in the mapped file and are never deserialized into tree nodes.
+    // A snapshot-backed server is read-only; AddDocument throws.
+    void LoadIndex(const std::string& path);
+
 private:
     struct DocumentData {
         int rating;
         DocumentStatus status;
     };
-    const std::set<std::string> stop_words_;
-    std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
+
+    struct Posting {
+        int document_id;
+        double term_freq;
+    };
+
+    // Flat per-document record used by the snapshot format, sorted by id.
+    struct DocumentEntry {
+        int id;
+        int rating;
+        DocumentStatus status;
+        RatingStats rating_stats;
+    };
+
+    // Cache-friendly view of the index: a sorted term dictionary whose
+    // postings lists live back to back in one contiguous array, addressed by
+    // [term_offsets[i], term_offsets[i + 1]). The *_storage vectors own the
+    // data when the view is built by Compact(); for a memory-mapped snapshot
+    // the pointers aim straight into the mapping instead.
+    struct CompactIndex {
+        std::vector<std::string> term_storage;
+        std::vector<std::string_view> terms;
+        std::vector<size_t> offset_storage;
+        const size_t* term_offsets = nullptr;
+        std::vector<Posting> posting_storage;
+        const Posting* postings = nullptr;
+        // Dense document slot per posting, parallel to the postings array,
+        // so the accumulation loop reads status and rating straight out of
+        // the slot arrays without any per-posting id lookup.
+        std::vector<std::uint32_t> posting_slots;
+        // IDF per term, precomputed when the view is frozen so queries read
+        // a double instead of calling log() per term.
+        std::vector<double> idfs;
+        // Largest term_freq in each postings list; max_term_freqs[t] *
+        // idfs[t] bounds the score any document can draw from term t, which
+        // is what MaxScore pruning needs to skip hopeless documents.
+        std::vector<double> max_term_freqs;
+        // Optional compressed postings: per term, delta-encoded varint
+        // document ids each followed by a term frequency quantized to
+        // 16-bit fixed point, decoded on the fly while scoring.
+        // compressed_byte_offsets holds the byte range per term. Trades
+        // ~1e-5 of relevance precision for a several-times smaller
+        // postings footprint; posting_storage stays empty in this mode.
+        std::vector<unsigned char> compressed_postings;
+        std::vector<size_t> compressed_byte_offsets;
+        bool compressed = false;
+        bool frozen = false;
+    };
+
+    // Sorted flat array probed with binary search per token.
+    const std::vector<std::string> stop_words_;
+
+    // Interning term dictionary: each distinct word is stored once (deque
+    // elements never move, so the lookup views stay valid) and mapped to a
+    // dense TermId indexing term_postings_.
+    std::deque<std::string> term_strings_;
+    std::unordered_map<std::string_view, TermId> term_ids_;
+    std::vector<std::map<int, double>> term_postings_;
+
+    // Per-document metadata in structure-of-arrays layout: external ids map
+    // to dense slots, and status and rating live in separate contiguous
+    // arrays indexed by slot. Slots of removed documents go stale and are
+    // reclaimed by the next Compact().
+    std::unordered_map<int, std::uint32_t> document_slots_;
+    std::vector<DocumentStatus> document_statuses_;
+    std::vector<int> document_ratings_;
+    std::vector<RatingStats> document_rating_stats_;
+    // One bitmap over slots per status, maintained alongside the slot
+    // arrays; the status overloads of FindTopDocuments test one bit per
+    // posting instead of calling the generic predicate. Removal clears the
+    // document's bit, so the bitmaps are authoritative even before the
+    // tombstones are reclaimed.
+    std::array<std::vector<bool>, 4> status_slots_;
+    // Forward index: every document's distinct words with their in-document
+    // frequencies, stored back to back and sorted by word within each
+    // document. Slot i owns entries [forward_offsets_[i],
+    // forward_offsets_[i + 1]); word views point at index-owned strings.
+    // Stale slots keep their entries until Compact() re-packs them.
+    std::vector<WordFrequency> forward_entries_;
+    std::vector<std::size_t> forward_offsets_{ 0 };
     std::vector<int> document_ids_;
+    // Tombstones: documents removed since the last Compact() whose postings
+    // are still physically present and must be skipped by queries.
+    std::set<int> removed_document_ids_;
+    CompactIndex compact_index_;
+
+    // Lazily filled IDF cache for the tree-based index; guarded by its own
+    // mutex so concurrent readers may share it, cleared by every write.
+    mutable std::mutex idf_cache_mutex_;
+    mutable std::unordered_map<TermId, double> idf_cache_;
 
-    bool IsStopWord(const std::string& word) const;
+    uint64_t index_version_ = 0;
 
-    static bool IsValidWord(const std::string& word);
+    // Keeps the mapped snapshot (or its fallback heap buffer) alive while
+    // the pointers below refer into it.
+    std::shared_ptr<void> snapshot_;
+    size_t snapshot_document_count_ = 0;
+    const int* snapshot_document_ids_ = nullptr;
 
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string& text) const;
+    bool IsStopWord(std::string_view word) const;
+
+    static bool IsValidWord(std::string_view word);
+
+    std::vector<std::string> SplitIntoWordsNoStop(std::string_view text) const;
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
 
     struct QueryWord {
-        std::string data;
+        std::string_view data;
         bool is_minus;
         bool is_stop;
     };
 
-    QueryWord ParseQueryWord(const std::string& text) const;
+    QueryWord ParseQueryWord(std::string_view text) const;
 
+    // Transient query state; its containers draw from the per-query arena
+    // so parsing a query costs no individual heap allocations. Terms are
+    // resolved to ids of the representation current at parse time; words
+    // absent from the index are dropped since they cannot match.
     struct Query {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
+        explicit Query(std::pmr::memory_resource* arena = std::pmr::get_default_resource())
+            : plus_terms(arena)
+            , minus_terms(arena) {
+        }
+        std::pmr::vector<TermId> plus_terms;
+        std::pmr::vector<TermId> minus_terms;
     };
 
-    Query ParseQuery(const std::string& text) const;
+    Query ParseQuery(std::string_view text,
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource()) const;
+
+    // Interns the word, creating a fresh id and empty postings on first use.
+    TermId InternTerm(std::string_view word);
+
+    // Id of the word in the current representation, or INVALID_TERM.
+    TermId ResolveTerm(std::string_view word) const;
+
+    // The word spelled by the id, owned by the index (dictionary entry or
+    // snapshot characters), so views outlive the query.
+    std::string_view GetTermString(TermId term_id) const;
+
+    double ComputeWordInverseDocumentFreq(TermId term_id) const;
+
+    void InvalidateIdfCache() const;
+
+    // Fills compact_index_.idfs from the frozen offsets and document count.
+    void ComputeCompactIdfs();
+
+    bool IsDocumentRemoved(int document_id) const;
+
+    // Physically erases one document's postings from the tree index;
+    // used when a tombstoned id is re-added before a Compact().
+    void PurgeDocumentPostings(int document_id);
+
+    // Number of documents containing the term, taken from whichever index
+    // representation is current.
+    size_t GetWordDocumentFreq(TermId term_id) const;
+
+    // Position of the word in the compact term dictionary, or NPOS.
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    size_t FindTermIndex(std::string_view word) const;
+
+    // Postings list of the term in the frozen compact index.
+    std::pair<const Posting*, const Posting*> GetCompactPostings(TermId term_id) const;
+
+    // Rating and status of the document, read from the slot arrays; throws
+    // std::out_of_range for unknown ids.
+    DocumentData GetDocumentData(int document_id) const;
 
-    double ComputeWordInverseDocumentFreq(const std::string& word) const;
+    // Appends a fresh slot for the document's metadata, computing the
+    // average rating and the retained rating summary in one pass.
+    void AddDocumentSlot(int document_id, DocumentStatus status,
+        const std::vector<int>& ratings);
+
+    // Status-specialized twin of AccumulateTermRelevance: filters against
+    // the status bitmap with one bit probe per posting, never touching the
+    // predicate machinery or the rating array.
+    void AccumulateTermRelevanceForStatus(TermId term_id, DocumentStatus status,
+        const std::pmr::vector<int>& excluded_documents,
+        std::pmr::map<int, double>& document_to_relevance) const;
+
+    // Binary search of the word in the slot's sorted forward entries; one
+    // contiguous probe regardless of the posting representation.
+    bool DocumentContainsWord(std::uint32_t slot, std::string_view word) const;
+
+    // Appends the forward-index entries of the document being added: the
+    // occurrence term ids are collapsed into per-word frequencies, resolved
+    // to index-owned views and sorted by word. Must be kept in step with
+    // AddDocumentSlot so offsets stay aligned with slots.
+    void AppendForwardEntries(std::vector<TermId> occurrence_terms);
+
+    // Fixed-point scale for quantized term frequencies; term_freq is always
+    // in (0, 1], so 16 bits cover it with ~1e-5 granularity.
+    static constexpr double TERM_FREQ_QUANT_SCALE = 65535.0;
+
+    // Little-endian base-128 varint; returns the position past the value.
+    static const unsigned char* DecodeVarint(const unsigned char* bytes, std::uint32_t& value) {
+        value = 0;
+        for (int shift = 0;; shift += 7) {
+            const unsigned char byte = *bytes++;
+            value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return bytes;
+            }
+        }
+    }
+
+    // Rebuilds max_term_freqs by scanning the flat postings; used after
+    // loading a snapshot, where Compact()'s inline bookkeeping did not run.
+    void ComputeCompactScoreBounds();
+
+    // Sorted dictionary order of the tree index's terms, skipping terms
+    // whose postings are empty; shared by Compact() and SaveIndex.
+    std::vector<std::pair<std::string_view, TermId>> SortedIndexedTerms() const;
+
+    // Invokes callback(document_id, term_freq) for every posting of the
+    // term in the current representation, dequantizing compressed
+    // frequencies; tombstoned postings are not filtered here.
+    template <typename PostingCallback>
+    void ForEachPosting(TermId term_id, PostingCallback callback) const;
 
     template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(
-        const Query& query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindAllDocuments(const Query& query, DocumentPredicate document_predicate,
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource()) const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&,
+        const Query& query, DocumentPredicate document_predicate,
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource()) const;
+
+    // Sorted ids of documents containing any minus term, built up front so
+    // plus-term accumulation can skip them before the predicate and
+    // accumulator work instead of erasing them afterwards.
+    std::pmr::vector<int> CollectExcludedDocuments(const Query& query,
+        std::pmr::memory_resource* arena) const;
+
+    // Per-slot flags for documents containing any minus term; slot-indexed
+    // so the corpus-wide match can test exclusion with one bit probe.
+    std::vector<bool> CollectExcludedSlots(const Query& query) const;
+
+    // Turns per-slot matched term lists into the MatchDocuments result:
+    // entries ordered by document id, words resolved to sorted views.
+    std::vector<DocumentMatch> BuildDocumentMatches(
+        const std::vector<std::vector<TermId>>& slot_terms) const;
+
+    // Adds the term_freq * idf contribution of one plus term to the accumulator,
+    // skipping tombstoned and minus-word-excluded documents.
+    template <typename DocumentPredicate, typename RelevanceMap>
+    void AccumulateTermRelevance(TermId term_id, DocumentPredicate& document_predicate,
+        const std::pmr::vector<int>& excluded_documents,
+        RelevanceMap& document_to_relevance) const;
+
+    std::vector<Document> BuildMatchedDocuments(
+        const std::pmr::map<int, double>& document_to_relevance) const;
+
+    // Orders the best top_k documents in place and drops the rest, using
+    // partial_sort so broad queries do not pay for a full O(n log n) sort.
+    static void SelectTopDocuments(std::vector<Document>& matched_documents, size_t top_k);
+
+    // Initial chunk handed to the per-query bump arena; the buffer is
+    // thread-local and reused across queries, so steady-state queries never
+    // touch the heap for transient containers.
+    static constexpr size_t QUERY_ARENA_INITIAL_BYTES = 64 * 1024;
+
+    static std::vector<char>& QueryArenaBuffer();
 };
 
 template <typename StringContainer>
-SearchServer::SearchServer(const StringContainer& stop_words) : stop_words_(MakeUniqueNonEmptyStrings(stop_words)) {
+SearchServer::SearchServer(const StringContainer& stop_words) : stop_words_(MakeSortedUniqueNonEmptyStrings(stop_words)) {
     if (!std::all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
         throw std::invalid_argument(std::string("Some of stop words are invalid"));
     }
@@ -85,62 +589,528 @@ SearchServer::SearchServer(const StringContainer& stop_words) : stop_words_(Make
 
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(
-    const std::string& raw_query, DocumentPredicate document_predicate) const {
-    const auto query = ParseQuery(raw_query);
+    std::string_view raw_query, DocumentPredicate document_predicate) const {
+    return FindTopDocuments(raw_query, document_predicate, MAX_RESULT_DOCUMENT_COUNT);
+}
 
-    auto matched_documents = FindAllDocuments(query, document_predicate);
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(
+    std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
+    SEARCH_STATS_ADD(queries, 1);
+    std::pmr::monotonic_buffer_resource arena(
+        QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    Query query(&arena);
+    {
+        SEARCH_STATS_TIMER(parse_timer, parse_ns);
+        query = ParseQuery(raw_query, &arena);
+    }
 
-    std::sort(matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            if (std::abs(lhs.relevance - rhs.relevance) < 1e-6) {
-                return lhs.rating > rhs.rating;
-            }
-            else {
-                return lhs.relevance > rhs.relevance;
+    std::vector<Document> matched_documents;
+    {
+        SEARCH_STATS_TIMER(accumulate_timer, accumulate_ns);
+        matched_documents = FindAllDocuments(query, document_predicate, &arena);
+    }
+
+    {
+        SEARCH_STATS_TIMER(rank_timer, rank_ns);
+        SelectTopDocuments(matched_documents, top_k);
+    }
+
+    return matched_documents;
+}
+
+template <typename PostingCallback>
+void SearchServer::ForEachPosting(TermId term_id, PostingCallback callback) const {
+    if (compact_index_.frozen && compact_index_.compressed) {
+        const unsigned char* bytes = compact_index_.compressed_postings.data() +
+            compact_index_.compressed_byte_offsets[term_id];
+        std::uint32_t document_id = 0;
+        const size_t count = compact_index_.term_offsets[term_id + 1] -
+            compact_index_.term_offsets[term_id];
+        for (size_t i = 0; i < count; ++i) {
+            std::uint32_t delta;
+            bytes = DecodeVarint(bytes, delta);
+            document_id += delta;
+            const std::uint16_t quantized =
+                static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+            bytes += 2;
+            callback(static_cast<int>(document_id), quantized / TERM_FREQ_QUANT_SCALE);
+        }
+        return;
+    }
+    if (compact_index_.frozen) {
+        const auto [first, last] = GetCompactPostings(term_id);
+        for (const Posting* posting = first; posting != last; ++posting) {
+            callback(posting->document_id, posting->term_freq);
+        }
+        return;
+    }
+    for (const auto& [document_id, term_freq] : term_postings_[term_id]) {
+        callback(document_id, term_freq);
+    }
+}
+
+template <typename ScoringFunction>
+std::vector<Document> SearchServer::FindTopDocumentsRanked(
+    std::string_view raw_query, ScoringFunction scoring, size_t top_k) const {
+    SEARCH_STATS_ADD(queries, 1);
+    std::pmr::monotonic_buffer_resource arena(
+        QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    Query query(&arena);
+    {
+        SEARCH_STATS_TIMER(parse_timer, parse_ns);
+        query = ParseQuery(raw_query, &arena);
+    }
+
+    std::vector<Document> matched_documents;
+    {
+        SEARCH_STATS_TIMER(accumulate_timer, accumulate_ns);
+        const auto excluded_documents = CollectExcludedDocuments(query, &arena);
+        std::pmr::map<int, double> document_to_relevance(&arena);
+        for (const TermId term_id : query.plus_terms) {
+            AccumulateTermRelevanceForStatus(term_id, DocumentStatus::ACTUAL,
+                excluded_documents, document_to_relevance);
+        }
+        matched_documents = BuildMatchedDocuments(document_to_relevance);
+    }
+
+    {
+        SEARCH_STATS_TIMER(rank_timer, rank_ns);
+        std::pmr::vector<std::pair<double, size_t>> scores(&arena);
+        scores.reserve(matched_documents.size());
+        for (size_t i = 0; i < matched_documents.size(); ++i) {
+            scores.push_back(
+                { scoring(matched_documents[i], GetRatingStats(matched_documents[i].id)), i });
+        }
+        const auto scores_higher = [&matched_documents](
+            const std::pair<double, size_t>& lhs, const std::pair<double, size_t>& rhs) {
+                if (lhs.first != rhs.first) {
+                    return lhs.first > rhs.first;
+                }
+                return matched_documents[lhs.second].id < matched_documents[rhs.second].id;
+            };
+        const size_t result_count = std::min(top_k, scores.size());
+        std::partial_sort(scores.begin(), scores.begin() + result_count, scores.end(),
+            scores_higher);
+        std::vector<Document> ranked_documents;
+        ranked_documents.reserve(result_count);
+        for (size_t i = 0; i < result_count; ++i) {
+            ranked_documents.push_back(matched_documents[scores[i].second]);
+        }
+        matched_documents = std::move(ranked_documents);
+    }
+
+    return matched_documents;
+}
+
+template <typename DocumentPredicate>
+std::vector<std::vector<Document>> SearchServer::FindTopDocumentsBatch(
+    const std::vector<std::string_view>& raw_queries,
+    DocumentPredicate document_predicate, size_t top_k) const {
+    std::pmr::monotonic_buffer_resource arena(
+        QueryArenaBuffer().data(), QueryArenaBuffer().size());
+
+    std::vector<Query> queries;
+    std::vector<std::pmr::vector<int>> excluded_documents;
+    queries.reserve(raw_queries.size());
+    excluded_documents.reserve(raw_queries.size());
+    {
+        SEARCH_STATS_TIMER(parse_timer, parse_ns);
+        for (const std::string_view raw_query : raw_queries) {
+            SEARCH_STATS_ADD(queries, 1);
+            queries.push_back(ParseQuery(raw_query, &arena));
+            excluded_documents.push_back(
+                CollectExcludedDocuments(queries.back(), &arena));
+        }
+    }
+
+    // Group the batch by plus term so each term's postings are walked once.
+    // The groups stay sorted by term id, matching the per-query term order
+    // of the single-query path, so accumulation order (and therefore the
+    // floating-point sums) are identical to a FindTopDocuments loop.
+    std::pmr::vector<std::pair<TermId, size_t>> subscriptions(&arena);
+    for (size_t query_index = 0; query_index < queries.size(); ++query_index) {
+        for (const TermId term_id : queries[query_index].plus_terms) {
+            subscriptions.push_back({ term_id, query_index });
+        }
+    }
+    std::sort(subscriptions.begin(), subscriptions.end());
+
+    std::vector<std::pmr::map<int, double>> accumulators;
+    accumulators.reserve(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        accumulators.emplace_back(&arena);
+    }
+
+    {
+        SEARCH_STATS_TIMER(accumulate_timer, accumulate_ns);
+        for (size_t group = 0; group < subscriptions.size();) {
+            const TermId term_id = subscriptions[group].first;
+            size_t group_end = group;
+            while (group_end < subscriptions.size() &&
+                subscriptions[group_end].first == term_id) {
+                ++group_end;
             }
-        });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+            const double inverse_document_freq = ComputeWordInverseDocumentFreq(term_id);
+            SEARCH_STATS_ADD(postings_scanned, GetWordDocumentFreq(term_id));
+            ForEachPosting(term_id, [&](int document_id, double term_freq) {
+                if (IsDocumentRemoved(document_id)) {
+                    return;
+                }
+                const auto document_data = GetDocumentData(document_id);
+                if (!document_predicate(document_id, document_data.status,
+                    document_data.rating)) {
+                    return;
+                }
+                const double contribution = term_freq * inverse_document_freq;
+                for (size_t i = group; i != group_end; ++i) {
+                    const size_t query_index = subscriptions[i].second;
+                    const auto& excluded = excluded_documents[query_index];
+                    if (!excluded.empty() &&
+                        std::binary_search(excluded.begin(), excluded.end(), document_id)) {
+                        continue;
+                    }
+                    accumulators[query_index][document_id] += contribution;
+                }
+            });
+            group = group_end;
+        }
+    }
+
+    std::vector<std::vector<Document>> results;
+    results.reserve(queries.size());
+    {
+        SEARCH_STATS_TIMER(rank_timer, rank_ns);
+        for (const auto& accumulator : accumulators) {
+            results.push_back(BuildMatchedDocuments(accumulator));
+            SelectTopDocuments(results.back(), top_k);
+        }
+    }
+    return results;
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(CompiledQuery& compiled_query,
+    DocumentPredicate document_predicate, size_t top_k) const {
+    SEARCH_STATS_ADD(queries, 1);
+    if (compiled_query.index_version_ != index_version_) {
+        compiled_query = CompileQuery(compiled_query.text_);
+    }
+    std::pmr::monotonic_buffer_resource arena(
+        QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    Query query(&arena);
+    query.plus_terms.assign(compiled_query.plus_terms_.begin(),
+        compiled_query.plus_terms_.end());
+    query.minus_terms.assign(compiled_query.minus_terms_.begin(),
+        compiled_query.minus_terms_.end());
+
+    std::vector<Document> matched_documents;
+    {
+        SEARCH_STATS_TIMER(accumulate_timer, accumulate_ns);
+        matched_documents = FindAllDocuments(query, document_predicate, &arena);
+    }
+
+    {
+        SEARCH_STATS_TIMER(rank_timer, rank_ns);
+        SelectTopDocuments(matched_documents, top_k);
     }
 
     return matched_documents;
 }
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(
-    const Query& query, DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+std::vector<Document> SearchServer::FindTopDocumentsPruned(
+    std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
+    // Pruning needs random access into flat postings; the tree index has
+    // neither bounds nor flat lists, and compressed postings only decode
+    // forward, so both fall back to the exhaustive path.
+    if (!compact_index_.frozen || compact_index_.compressed) {
+        return FindTopDocuments(raw_query, document_predicate, top_k);
+    }
+    if (top_k == 0) {
+        return {};
+    }
+    SEARCH_STATS_ADD(queries, 1);
+    std::pmr::monotonic_buffer_resource arena(
+        QueryArenaBuffer().data(), QueryArenaBuffer().size());
+    const auto query = ParseQuery(raw_query, &arena);
+    const auto excluded_documents = CollectExcludedDocuments(query, &arena);
+
+    // Term cursors ordered by ascending score bound; the prefix with a
+    // cumulative bound below the threshold is non-essential: documents
+    // appearing only there can never reach the top K.
+    struct TermCursor {
+        const Posting* current;
+        const Posting* last;
+        double idf;
+        double bound;
+    };
+    std::pmr::vector<TermCursor> cursors(&arena);
+    cursors.reserve(query.plus_terms.size());
+    for (const TermId term_id : query.plus_terms) {
+        const auto [first, last] = GetCompactPostings(term_id);
+        if (first != last) {
+            cursors.push_back({ first, last, compact_index_.idfs[term_id],
+                compact_index_.max_term_freqs[term_id] * compact_index_.idfs[term_id] });
+        }
+    }
+    std::sort(cursors.begin(), cursors.end(),
+        [](const TermCursor& lhs, const TermCursor& rhs) { return lhs.bound < rhs.bound; });
+    std::pmr::vector<double> prefix_bounds(&arena);
+    prefix_bounds.reserve(cursors.size());
+    double bound_sum = 0.0;
+    for (const TermCursor& cursor : cursors) {
+        bound_sum += cursor.bound;
+        prefix_bounds.push_back(bound_sum);
+    }
+
+    // Min-heap of the K best relevances accepted so far; the pruning
+    // threshold keeps a 1e-6 margin so relevance ties (broken by rating)
+    // are never pruned and results stay identical to the exhaustive path.
+    std::priority_queue<double, std::vector<double>, std::greater<>> best_relevances;
+    const auto threshold = [&best_relevances, top_k] {
+        return best_relevances.size() < top_k
+            ? -std::numeric_limits<double>::infinity()
+            : best_relevances.top() - 1e-6;
+    };
+
+    std::vector<Document> candidates;
+    size_t pivot = 0;
+    while (true) {
+        while (pivot < cursors.size() && prefix_bounds[pivot] <= threshold()) {
+            ++pivot;
+        }
+        if (pivot == cursors.size()) {
+            break;
+        }
+        int document_id = std::numeric_limits<int>::max();
+        for (size_t i = pivot; i < cursors.size(); ++i) {
+            if (cursors[i].current != cursors[i].last) {
+                document_id = std::min(document_id, cursors[i].current->document_id);
+            }
+        }
+        if (document_id == std::numeric_limits<int>::max()) {
+            break;
+        }
+        double relevance = 0.0;
+        for (size_t i = pivot; i < cursors.size(); ++i) {
+            TermCursor& cursor = cursors[i];
+            if (cursor.current != cursor.last && cursor.current->document_id == document_id) {
+                relevance += cursor.current->term_freq * cursor.idf;
+                ++cursor.current;
+            }
+        }
+        if (IsDocumentRemoved(document_id) ||
+            (!excluded_documents.empty() &&
+                std::binary_search(excluded_documents.begin(), excluded_documents.end(),
+                    document_id))) {
             continue;
         }
-        const double inverse_document_freq =
-            ComputeWordInverseDocumentFreq(word);
-        for (const auto& [document_id, term_freq] :
-            word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status,
-                document_data.rating)) {
-                document_to_relevance[document_id] +=
-                    term_freq * inverse_document_freq;
+        // Complete the score from the non-essential lists, best bound first,
+        // bailing out as soon as the remaining potential cannot reach the
+        // threshold.
+        bool pruned = false;
+        for (size_t j = pivot; j-- > 0;) {
+            if (relevance + prefix_bounds[j] <= threshold()) {
+                pruned = true;
+                break;
+            }
+            TermCursor& cursor = cursors[j];
+            cursor.current = std::lower_bound(cursor.current, cursor.last, document_id,
+                [](const Posting& lhs, int id) { return lhs.document_id < id; });
+            if (cursor.current != cursor.last && cursor.current->document_id == document_id) {
+                relevance += cursor.current->term_freq * cursor.idf;
+                ++cursor.current;
             }
         }
+        if (pruned) {
+            continue;
+        }
+        const auto document_data = GetDocumentData(document_id);
+        if (!document_predicate(document_id, document_data.status, document_data.rating)) {
+            continue;
+        }
+        candidates.push_back({ document_id, relevance, document_data.rating });
+        if (best_relevances.size() < top_k) {
+            best_relevances.push(relevance);
+        }
+        else if (relevance > best_relevances.top()) {
+            best_relevances.pop();
+            best_relevances.push(relevance);
+        }
     }
 
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+    SEARCH_STATS_ADD(candidate_documents, candidates.size());
+    {
+        SEARCH_STATS_TIMER(rank_timer, rank_ns);
+        SelectTopDocuments(candidates, top_k);
+    }
+    return candidates;
+}
+
+template <typename DocumentPredicate>
+std::future<std::vector<Document>> SearchServer::FindTopDocumentsAsync(
+    std::string raw_query, DocumentPredicate document_predicate) const {
+    return QueryPool().Submit(
+        [this, raw_query = std::move(raw_query), document_predicate] {
+            return FindTopDocuments(raw_query, document_predicate);
+        });
+}
+
+template <typename ExecutionPolicy, typename DocumentPredicate, typename>
+std::vector<Document> SearchServer::FindTopDocuments(
+    ExecutionPolicy&& policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
+    return FindTopDocuments(policy, raw_query, document_predicate, MAX_RESULT_DOCUMENT_COUNT);
+}
+
+template <typename ExecutionPolicy, typename DocumentPredicate, typename>
+std::vector<Document> SearchServer::FindTopDocuments(
+    ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate, size_t top_k) const {
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::parallel_policy>) {
+        std::pmr::monotonic_buffer_resource arena(
+            QueryArenaBuffer().data(), QueryArenaBuffer().size());
+        const auto query = ParseQuery(raw_query, &arena);
+
+        auto matched_documents = FindAllDocuments(policy, query, document_predicate, &arena);
+
+        SelectTopDocuments(matched_documents, top_k);
+
+        return matched_documents;
+    }
+    else {
+        return FindTopDocuments(raw_query, document_predicate, top_k);
+    }
+}
+
+template <typename ExecutionPolicy, typename>
+std::vector<Document> SearchServer::FindTopDocuments(
+    ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocuments(
+        policy, raw_query,
+        [status]([[maybe_unused]] int document_id, DocumentStatus document_status,
+            [[maybe_unused]] int rating) { return document_status == status; });
+}
+
+template <typename ExecutionPolicy, typename>
+std::vector<Document> SearchServer::FindTopDocuments(
+    ExecutionPolicy&& policy, std::string_view raw_query) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+}
+
+template <typename DocumentPredicate, typename RelevanceMap>
+void SearchServer::AccumulateTermRelevance(TermId term_id,
+    DocumentPredicate& document_predicate, const std::pmr::vector<int>& excluded_documents,
+    RelevanceMap& document_to_relevance) const {
+    const auto is_excluded = [&excluded_documents](int document_id) {
+        return !excluded_documents.empty() &&
+            std::binary_search(excluded_documents.begin(), excluded_documents.end(),
+                document_id);
+    };
+    if (compact_index_.frozen) {
+        const size_t first = compact_index_.term_offsets[term_id];
+        const size_t last = compact_index_.term_offsets[term_id + 1];
+        const double inverse_document_freq = compact_index_.idfs[term_id];
+        SEARCH_STATS_ADD(postings_scanned, last - first);
+        if (compact_index_.compressed) {
+            const unsigned char* bytes = compact_index_.compressed_postings.data() +
+                compact_index_.compressed_byte_offsets[term_id];
+            std::uint32_t document_id = 0;
+            for (size_t i = first; i != last; ++i) {
+                std::uint32_t delta;
+                bytes = DecodeVarint(bytes, delta);
+                document_id += delta;
+                const std::uint16_t quantized =
+                    static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+                bytes += 2;
+                if (IsDocumentRemoved(document_id) || is_excluded(document_id)) {
+                    continue;
+                }
+                const std::uint32_t slot = compact_index_.posting_slots[i];
+                if (document_predicate(document_id, document_statuses_[slot],
+                    document_ratings_[slot])) {
+                    document_to_relevance[static_cast<int>(document_id)] +=
+                        (quantized / TERM_FREQ_QUANT_SCALE) * inverse_document_freq;
+                }
+            }
+            return;
+        }
+        for (size_t i = first; i != last; ++i) {
+            const Posting& posting = compact_index_.postings[i];
+            if (IsDocumentRemoved(posting.document_id) || is_excluded(posting.document_id)) {
+                continue;
+            }
+            const std::uint32_t slot = compact_index_.posting_slots[i];
+            if (document_predicate(posting.document_id, document_statuses_[slot],
+                document_ratings_[slot])) {
+                document_to_relevance[posting.document_id] +=
+                    posting.term_freq * inverse_document_freq;
+            }
+        }
+        return;
+    }
+    const auto& postings = term_postings_[term_id];
+    if (postings.empty()) {
+        return;
+    }
+    SEARCH_STATS_ADD(postings_scanned, postings.size());
+    const double inverse_document_freq = ComputeWordInverseDocumentFreq(term_id);
+    for (const auto& [document_id, term_freq] : postings) {
+        if (IsDocumentRemoved(document_id) || is_excluded(document_id)) {
             continue;
         }
-        for (const auto& [document_id, _] :
-            word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+        const auto document_data = GetDocumentData(document_id);
+        if (document_predicate(document_id, document_data.status,
+            document_data.rating)) {
+            document_to_relevance[document_id] +=
+                term_freq * inverse_document_freq;
         }
     }
+}
 
-    std::vector<Document> matched_documents;
-    for (const auto& [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back(
-            { document_id, relevance, documents_.at(document_id).rating });
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindAllDocuments(
+    const Query& query, DocumentPredicate document_predicate,
+    std::pmr::memory_resource* arena) const {
+    const auto excluded_documents = CollectExcludedDocuments(query, arena);
+
+    std::pmr::map<int, double> document_to_relevance(arena);
+    for (const TermId term_id : query.plus_terms) {
+        AccumulateTermRelevance(term_id, document_predicate, excluded_documents,
+            document_to_relevance);
     }
-    return matched_documents;
-}
\ No newline at end of file
+
+    return BuildMatchedDocuments(document_to_relevance);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
+    const Query& query, DocumentPredicate document_predicate,
+    std::pmr::memory_resource* arena) const {
+    const auto excluded_documents = CollectExcludedDocuments(query, arena);
+
+    const size_t worker_count = std::min<size_t>(
+        std::max<size_t>(1, std::thread::hardware_concurrency()), query.plus_terms.size());
+    std::vector<std::future<std::map<int, double>>> partial_results;
+    partial_results.reserve(worker_count);
+    for (size_t worker = 0; worker < worker_count; ++worker) {
+        partial_results.push_back(std::async(std::launch::async,
+            [this, worker, worker_count, &query, &document_predicate, &excluded_documents] {
+                std::map<int, double> local_relevance;
+                for (size_t i = worker; i < query.plus_terms.size(); i += worker_count) {
+                    AccumulateTermRelevance(query.plus_terms[i], document_predicate,
+                        excluded_documents, local_relevance);
+                }
+                return local_relevance;
+            }));
+    }
+
+    std::pmr::map<int, double> document_to_relevance(arena);
+    for (auto& partial : partial_results) {
+        for (const auto& [document_id, relevance] : partial.get()) {
+            document_to_relevance[document_id] += relevance;
+        }
+    }
+
+    return BuildMatchedDocuments(document_to_relevance);
+}
@@ -0,0 +1,67 @@
+#include "search_stats.h"
+
+#ifndef SEARCH_SERVER_DISABLE_STATS
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace stats_internal {
+
+namespace {
+
+struct Registry {
+    mutex mutex_;
+    vector<unique_ptr<StatsSlot>> slots;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+}  // namespace
+
+StatsSlot& LocalSlot() {
+    thread_local StatsSlot* slot = [] {
+        Registry& registry = GetRegistry();
+        lock_guard guard(registry.mutex_);
+        registry.slots.push_back(make_unique<StatsSlot>());
+        return registry.slots.back().get();
+    }();
+    return *slot;
+}
+
+SearchStats AggregateSlots() {
+    SearchStats total;
+    Registry& registry = GetRegistry();
+    lock_guard guard(registry.mutex_);
+    for (const auto& slot : registry.slots) {
+        total.queries += slot->queries.load(memory_order_relaxed);
+        total.postings_scanned += slot->postings_scanned.load(memory_order_relaxed);
+        total.candidate_documents += slot->candidate_documents.load(memory_order_relaxed);
+        total.parse_ns += slot->parse_ns.load(memory_order_relaxed);
+        total.accumulate_ns += slot->accumulate_ns.load(memory_order_relaxed);
+        total.rank_ns += slot->rank_ns.load(memory_order_relaxed);
+    }
+    return total;
+}
+
+void ResetSlots() {
+    Registry& registry = GetRegistry();
+    lock_guard guard(registry.mutex_);
+    for (const auto& slot : registry.slots) {
+        slot->queries.store(0, memory_order_relaxed);
+        slot->postings_scanned.store(0, memory_order_relaxed);
+        slot->candidate_documents.store(0, memory_order_relaxed);
+        slot->parse_ns.store(0, memory_order_relaxed);
+        slot->accumulate_ns.store(0, memory_order_relaxed);
+        slot->rank_ns.store(0, memory_order_relaxed);
+    }
+}
+
+}  // namespace stats_internal
+
+#endif
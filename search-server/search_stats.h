@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Hot-path instrumentation for the query engine. Counters are written to
+// thread-local slots with relaxed atomics -- one uncontended add per event
+// -- and aggregated across threads only when read, so steady-state query
+// cost is negligible. Define SEARCH_SERVER_DISABLE_STATS to compile every
+// probe out entirely.
+
+// Aggregated engine counters as returned by SearchServer::GetStats().
+struct SearchStats {
+    std::uint64_t queries = 0;
+    // Postings visited by relevance accumulation across all queries.
+    std::uint64_t postings_scanned = 0;
+    // Documents that survived matching and reached ranking.
+    std::uint64_t candidate_documents = 0;
+    // Cumulative wall time per query stage.
+    std::uint64_t parse_ns = 0;
+    std::uint64_t accumulate_ns = 0;
+    std::uint64_t rank_ns = 0;
+};
+
+#ifndef SEARCH_SERVER_DISABLE_STATS
+
+namespace stats_internal {
+
+struct StatsSlot {
+    std::atomic<std::uint64_t> queries{ 0 };
+    std::atomic<std::uint64_t> postings_scanned{ 0 };
+    std::atomic<std::uint64_t> candidate_documents{ 0 };
+    std::atomic<std::uint64_t> parse_ns{ 0 };
+    std::atomic<std::uint64_t> accumulate_ns{ 0 };
+    std::atomic<std::uint64_t> rank_ns{ 0 };
+};
+
+// The calling thread's slot; registered in the process-wide registry on
+// first use and kept alive for the process lifetime, so aggregation never
+// races slot destruction.
+StatsSlot& LocalSlot();
+
+SearchStats AggregateSlots();
+
+void ResetSlots();
+
+}  // namespace stats_internal
+
+#define SEARCH_STATS_ADD(field, amount) \
+    stats_internal::LocalSlot().field.fetch_add((amount), std::memory_order_relaxed)
+
+// Charges the enclosing scope's wall time to one stage counter.
+class ScopedStageTimer {
+public:
+    using Field = std::atomic<std::uint64_t> stats_internal::StatsSlot::*;
+
+    explicit ScopedStageTimer(Field field)
+        : field_(field)
+        , started_(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedStageTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - started_;
+        (stats_internal::LocalSlot().*field_).fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+    }
+
+private:
+    Field field_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+#define SEARCH_STATS_TIMER(name, field) \
+    ScopedStageTimer name(&stats_internal::StatsSlot::field)
+
+#else
+
+#define SEARCH_STATS_ADD(field, amount) ((void)0)
+#define SEARCH_STATS_TIMER(name, field) ((void)0)
+
+#endif
@@ -0,0 +1,69 @@
+#include "sharded_search_server.h"
+
+using namespace std;
+
+ShardedSearchServer::ShardedSearchServer(string_view stop_words_text, size_t shard_count) {
+    shards_.reserve(max<size_t>(1, shard_count));
+    for (size_t shard = 0; shard < max<size_t>(1, shard_count); ++shard) {
+        shards_.push_back(make_unique<SearchServer>(stop_words_text));
+    }
+}
+
+void ShardedSearchServer::AddDocument(int document_id, string_view document,
+    DocumentStatus status, const vector<int>& ratings) {
+    shards_[ShardIndex(document_id)]->AddDocument(document_id, document, status, ratings);
+}
+
+void ShardedSearchServer::AddDocuments(const vector<SearchServer::DocumentInput>& documents) {
+    vector<vector<SearchServer::DocumentInput>> shard_batches(shards_.size());
+    for (const SearchServer::DocumentInput& document : documents) {
+        shard_batches[ShardIndex(document.id)].push_back(document);
+    }
+    for (size_t shard = 0; shard < shards_.size(); ++shard) {
+        if (!shard_batches[shard].empty()) {
+            shards_[shard]->AddDocuments(shard_batches[shard]);
+        }
+    }
+}
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    shards_[ShardIndex(document_id)]->RemoveDocument(document_id);
+}
+
+vector<Document> ShardedSearchServer::FindTopDocuments(string_view raw_query,
+    DocumentStatus status) const {
+    return ScatterGather([raw_query, status](const SearchServer& shard) {
+        return shard.FindTopDocuments(raw_query, status);
+    });
+}
+
+vector<Document> ShardedSearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+tuple<vector<string_view>, DocumentStatus> ShardedSearchServer::MatchDocument(
+    string_view raw_query, int document_id) const {
+    return shards_[ShardIndex(document_id)]->MatchDocument(raw_query, document_id);
+}
+
+int ShardedSearchServer::GetDocumentCount() const {
+    int document_count = 0;
+    for (const auto& shard : shards_) {
+        document_count += shard->GetDocumentCount();
+    }
+    return document_count;
+}
+
+size_t ShardedSearchServer::GetShardCount() const {
+    return shards_.size();
+}
+
+void ShardedSearchServer::Compact(bool compress_postings) {
+    for (const auto& shard : shards_) {
+        shard->Compact(compress_postings);
+    }
+}
+
+size_t ShardedSearchServer::ShardIndex(int document_id) const {
+    return hash<int>{}(document_id) % shards_.size();
+}
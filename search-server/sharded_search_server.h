@@ -0,0 +1,103 @@
+#pragma once
+#include "document.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// Document-partitioned facade over N internal SearchServer shards, meant to
+// be sized one shard per memory domain on multi-socket hosts: each shard's
+// postings and metadata are touched only by the workers querying it, so
+// traversals stay on the memory the shard was built on instead of paying
+// remote-node latency against one monolithic index. Documents route to a
+// shard by id hash; FindTopDocuments scatters the query across all shards
+// on the shared pool and merges the per-shard top-K lists with the same
+// comparator FindTopDocuments itself ranks by. The default of a single
+// shard behaves exactly like a bare SearchServer. With several shards,
+// inverse document frequencies are computed from per-shard statistics, so
+// relevance can deviate slightly from a monolithic index when a term's
+// documents spread unevenly across shards.
+class ShardedSearchServer {
+public:
+    template <typename StringContainer>
+    explicit ShardedSearchServer(const StringContainer& stop_words, size_t shard_count = 1) {
+        shards_.reserve(std::max<size_t>(1, shard_count));
+        for (size_t shard = 0; shard < std::max<size_t>(1, shard_count); ++shard) {
+            shards_.push_back(std::make_unique<SearchServer>(stop_words));
+        }
+    }
+
+    explicit ShardedSearchServer(std::string_view stop_words_text, size_t shard_count = 1);
+
+    void AddDocument(int document_id, std::string_view document,
+        DocumentStatus status, const std::vector<int>& ratings);
+
+    // Splits the batch by shard and bulk-loads each part. Each shard
+    // validates its own part, so a rejected document may leave documents
+    // already accepted by other shards in place.
+    void AddDocuments(const std::vector<SearchServer::DocumentInput>& documents);
+
+    void RemoveDocument(int document_id);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentPredicate document_predicate) const {
+        return ScatterGather([raw_query, &document_predicate](const SearchServer& shard) {
+            return shard.FindTopDocuments(raw_query, document_predicate);
+        });
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        std::string_view raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+
+    size_t GetShardCount() const;
+
+    void Compact(bool compress_postings = false);
+
+private:
+    std::vector<std::unique_ptr<SearchServer>> shards_;
+
+    size_t ShardIndex(int document_id) const;
+
+    // Runs shard_query against every shard on the shared query pool and
+    // merges the per-shard result lists; shards partition the documents,
+    // so the global top-K is always contained in the shard top-K lists.
+    template <typename ShardQuery>
+    std::vector<Document> ScatterGather(ShardQuery shard_query) const;
+};
+
+template <typename ShardQuery>
+std::vector<Document> ShardedSearchServer::ScatterGather(ShardQuery shard_query) const {
+    if (shards_.size() == 1) {
+        return shard_query(*shards_.front());
+    }
+    std::vector<std::future<std::vector<Document>>> shard_results;
+    shard_results.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+        shard_results.push_back(SearchServer::QueryPool().Submit(
+            [&shard_query, &shard] { return shard_query(*shard); }));
+    }
+    std::vector<Document> merged;
+    for (auto& result : shard_results) {
+        const auto partial = result.get();
+        merged.insert(merged.end(), partial.begin(), partial.end());
+    }
+    std::sort(merged.begin(), merged.end(), RanksHigher);
+    if (merged.size() > static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT)) {
+        merged.resize(MAX_RESULT_DOCUMENT_COUNT);
+    }
+    return merged;
+}
@@ -1,24 +1,94 @@
 #include "string_processing.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
-vector<string> SplitIntoWords(const string& text) {
-    vector<string> words;
-    string word;
-    for (const char c : text) {
-        if (c == ' ') {
-            if (!word.empty()) {
-                words.push_back(word);
-                word.clear();
-            }
+namespace {
+
+#ifdef __SSE2__
+
+int CountTrailingZeros(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int count = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Both scanners examine 16 bytes per step and fall back to a byte loop
+// only for the unaligned tail.
+
+size_t FindSpace(string_view text, size_t pos) {
+    const __m128i spaces = _mm_set1_epi8(' ');
+    while (pos + 16 <= text.size()) {
+        const __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+        const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, spaces));
+        if (mask != 0) {
+            return pos + CountTrailingZeros(mask);
         }
-        else {
-            word += c;
+        pos += 16;
+    }
+    while (pos < text.size() && text[pos] != ' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+size_t FindNonSpace(string_view text, size_t pos) {
+    const __m128i spaces = _mm_set1_epi8(' ');
+    while (pos + 16 <= text.size()) {
+        const __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+        const unsigned mask =
+            ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, spaces))) & 0xFFFFu;
+        if (mask != 0) {
+            return pos + CountTrailingZeros(mask);
         }
+        pos += 16;
     }
-    if (!word.empty()) {
-        words.push_back(word);
+    while (pos < text.size() && text[pos] == ' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+#else
+
+size_t FindSpace(string_view text, size_t pos) {
+    while (pos < text.size() && text[pos] != ' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+size_t FindNonSpace(string_view text, size_t pos) {
+    while (pos < text.size() && text[pos] == ' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+#endif
+
+}  // namespace
+
+vector<string_view> SplitIntoWords(string_view text) {
+    vector<string_view> words;
+    size_t pos = FindNonSpace(text, 0);
+    while (pos < text.size()) {
+        const size_t end = FindSpace(text, pos);
+        words.push_back(text.substr(pos, end - pos));
+        pos = FindNonSpace(text, end);
     }
 
     return words;
-}
\ No newline at end of file
+}
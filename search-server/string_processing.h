@@ -1,17 +1,24 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 #include <set>
 
-std::vector<std::string> SplitIntoWords(const std::string& text);
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
 
 template <typename StringContainer>
-std::set<std::string> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
-    std::set<std::string> non_empty_strings;
-    for (const std::string& str : strings) {
+std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
+    std::set<std::string, std::less<>> non_empty_strings;
+    for (std::string_view str : strings) {
         if (!str.empty()) {
-            non_empty_strings.insert(str);
+            non_empty_strings.insert(std::string(str));
         }
     }
     return non_empty_strings;
-}
\ No newline at end of file
+}
+
+template <typename StringContainer>
+std::vector<std::string> MakeSortedUniqueNonEmptyStrings(const StringContainer& strings) {
+    const auto unique_strings = MakeUniqueNonEmptyStrings(strings);
+    return { unique_strings.begin(), unique_strings.end() };
+}
@@ -0,0 +1,47 @@
+#include "thread_pool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this] {
+            while (true) {
+                function<void()> job;
+                {
+                    unique_lock lock(mutex_);
+                    ready_.wait(lock, [this] { return !jobs_.empty() || stopping_; });
+                    if (jobs_.empty()) {
+                        return;
+                    }
+                    job = move(jobs_.front());
+                    jobs_.pop_front();
+                }
+                job();
+            }
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::ThreadCount() const {
+    return workers_.size();
+}
+
+void ThreadPool::Enqueue(function<void()> job) {
+    {
+        lock_guard lock(mutex_);
+        jobs_.push_back(move(job));
+    }
+    ready_.notify_one();
+}
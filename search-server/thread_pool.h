@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool with one shared task queue. Submit() hands back a
+// future for the task's result; tasks run in submission order as workers
+// free up. Destruction drains nothing: pending tasks still execute before
+// the workers join, so futures obtained earlier never dangle.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename Task>
+    auto Submit(Task task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        auto result = packaged->get_future();
+        Enqueue([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    size_t ThreadCount() const;
+
+private:
+    void Enqueue(std::function<void()> job);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> jobs_;
+    bool stopping_ = false;
+};